@@ -0,0 +1,153 @@
+#include "headers/CollectorDaemon.h"
+#include "headers/MetricsExporter.h"
+#include "headers/SnapshotServer.h"
+#include "headers/SystemSampler.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <getopt.h>
+
+static volatile sig_atomic_t g_stopRequested = 0;
+
+static void requestStop(int) {
+    g_stopRequested = 1;
+}
+
+static void printUsage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [--socket PATH] [--interval MS] [--workers N]\n"
+                 "          [--metrics-port PORT [--metrics-address ADDR] [--metrics-top N]]\n"
+                 "  --socket PATH          where viewers attach (default %s)\n"
+                 "  --interval MS          time between samples (default 1000)\n"
+                 "  --workers N            threads for the process walk (default %u)\n"
+                 "  --metrics-port PORT    also serve OpenMetrics on http://ADDR:PORT/metrics\n"
+                 "  --metrics-address ADDR address to serve them on (default 127.0.0.1)\n"
+                 "  --metrics-top N        processes exported by CPU and by memory (default 20)\n",
+                 program, SnapshotServer::defaultSocketPath().c_str(),
+                 ProcessSampler::defaultWorkerCount());
+}
+
+int collectorDaemonMain(int argc, char* argv[]) {
+    std::string socketPath = SnapshotServer::defaultSocketPath();
+    int intervalMs = 1000;
+    unsigned workers = ProcessSampler::defaultWorkerCount();
+    int metricsPort = -1;
+    std::string metricsAddress = "127.0.0.1";
+    int metricsTop = 20;
+
+    static const option longOptions[] = {
+        {"socket", required_argument, nullptr, 's'},
+        {"interval", required_argument, nullptr, 'i'},
+        {"workers", required_argument, nullptr, 'w'},
+        {"metrics-port", required_argument, nullptr, 'p'},
+        {"metrics-address", required_argument, nullptr, 'a'},
+        {"metrics-top", required_argument, nullptr, 't'},
+        {"headless", no_argument, nullptr, 'H'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        switch (opt) {
+            case 's': socketPath = optarg; break;
+            case 'i': intervalMs = std::atoi(optarg); break;
+            case 'w': workers = static_cast<unsigned>(std::atoi(optarg)); break;
+            case 'p': metricsPort = std::atoi(optarg); break;
+            case 'a': metricsAddress = optarg; break;
+            case 't': metricsTop = std::atoi(optarg); break;
+            case 'H': break;    // how GUITaskManager got here
+            case 'h': printUsage(argv[0]); return 0;
+            default: printUsage(argv[0]); return 1;
+        }
+    }
+    if (intervalMs <= 0 || workers == 0 || metricsPort > 65535 || metricsTop < 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // No SA_RESTART, so a signal also cuts poll() short.
+    struct sigaction action = {};
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    ProcessParser parser;
+    std::vector<std::string> mountPaths = parser.getMountedPartitions();
+
+    SnapshotServer server;
+    if (!server.listen(socketPath, mountPaths)) {
+        std::fprintf(stderr, "%s\n", server.error().c_str());
+        return 1;
+    }
+    std::fprintf(stderr, "Serving snapshots on %s\n", socketPath.c_str());
+
+    // Scrapes are answered from the last tick, so with an exporter every
+    // tick samples everything it shows, viewers or not. GPUs are read from
+    // sysfs only: rocm-smi forks and is too slow for the sampling thread.
+    std::unique_ptr<MetricsExporter> exporter;
+    std::unique_ptr<GpuSampler> gpuSampler;
+    std::vector<InterfaceCounters> interfaces;
+    std::vector<GpuSample> gpus;
+    if (metricsPort >= 0) {
+        exporter.reset(new MetricsExporter(static_cast<size_t>(metricsTop)));
+        if (!exporter->listen(metricsAddress, static_cast<uint16_t>(metricsPort))) {
+            std::fprintf(stderr, "%s\n", exporter->error().c_str());
+            return 1;
+        }
+        gpuSampler.reset(new GpuSampler(SystemRoots(), false));
+        std::fprintf(stderr, "Serving metrics on http://%s:%u/metrics\n",
+                     metricsAddress.c_str(), static_cast<unsigned>(exporter->port()));
+    }
+
+    SystemSampler sampler(mountPaths, workers);
+    const std::chrono::milliseconds interval(intervalMs);
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    while (!g_stopRequested) {
+        next += interval;
+        for (;;) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (now >= next || g_stopRequested) break;
+            server.poll(static_cast<int>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count()) + 1);
+        }
+        if (g_stopRequested) break;
+        // A slow tick moves the schedule instead of being made up in a burst.
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now - next > interval) {
+            next = now;
+        }
+
+        // Nobody watching, nothing to walk.
+        if (server.clientCount() == 0 && !exporter) {
+            continue;
+        }
+        SamplePlan plan;
+        plan.metrics = server.metrics();
+        plan.processFields = server.processFields();
+        if (exporter) {
+            plan.metrics = MetricAll;
+            plan.processFields |= SampleOwner | SampleIo;
+        }
+        try {
+            std::shared_ptr<const StatsSnapshot> snapshot = sampler.collect(plan);
+            server.publish(*snapshot);
+            if (exporter) {
+                parser.getInterfaceCounters(interfaces);
+                gpuSampler->sample(gpus);
+                exporter->publish(*snapshot, interfaces, gpus);
+            }
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "Sampling failed: %s\n", e.what());
+        }
+    }
+
+    if (exporter) {
+        exporter->close();
+    }
+    server.close();
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "headers/CpuFreqSampler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+
+// Samples between re-reads of the /proc/cpuinfo fallback; one a second
+// makes it once a minute.
+static const unsigned kCpuinfoRefreshSamples = 60;
+
+// CPU number of a "cpuN" entry, or -1 for cpufreq, cpuidle and the rest.
+static int cpuNumber(const char* name) {
+    if (std::strncmp(name, "cpu", 3) != 0 || name[3] == '\0') {
+        return -1;
+    }
+    for (const char* p = name + 3; *p; ++p) {
+        if (*p < '0' || *p > '9') return -1;
+    }
+    return std::atoi(name + 3);
+}
+
+// cpufreq files hold a single number in kHz.
+static bool readKhz(int fd, long& khz) {
+    char buf[32];
+    ssize_t len = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (len <= 0) {
+        return false;
+    }
+    buf[len] = '\0';
+    char* end = nullptr;
+    khz = std::strtol(buf, &end, 10);
+    return end != buf && khz > 0;
+}
+
+CpuFreqSampler::CpuFreqSampler(const SystemRoots& roots)
+    : m_cpuinfoPath(roots.proc + "/cpuinfo") {
+    std::string cpuRoot = roots.sys + "/devices/system/cpu";
+    DIR* dir = opendir(cpuRoot.c_str());
+    if (!dir) {
+        return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        int cpu = cpuNumber(entry->d_name);
+        if (cpu < 0) {
+            continue;
+        }
+        if (static_cast<size_t>(cpu) >= m_fds.size()) {
+            m_fds.resize(cpu + 1, -1);
+        }
+        std::string freqDir = cpuRoot + "/" + entry->d_name + "/cpufreq/";
+        m_fds[cpu] = open((freqDir + "scaling_cur_freq").c_str(), O_RDONLY | O_CLOEXEC);
+
+        int maxFd = open((freqDir + "cpuinfo_max_freq").c_str(), O_RDONLY | O_CLOEXEC);
+        if (maxFd >= 0) {
+            long khz = 0;
+            if (readKhz(maxFd, khz)) {
+                m_ratedMaxMhz = std::max(m_ratedMaxMhz, khz / 1000.0);
+            }
+            close(maxFd);
+        }
+    }
+    closedir(dir);
+
+    m_available = std::any_of(m_fds.begin(), m_fds.end(), [](int fd) { return fd >= 0; });
+    if (!m_available) {
+        readCpuinfo();
+    }
+}
+
+CpuFreqSampler::~CpuFreqSampler() {
+    for (int fd : m_fds) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+void CpuFreqSampler::sample(CpuFreqSample& out) {
+    out.ratedMaxMhz = m_ratedMaxMhz;
+    if (!m_available) {
+        if (++m_samplesSinceCpuinfo >= kCpuinfoRefreshSamples) {
+            readCpuinfo();
+        }
+        out.perCpuMhz.assign(m_cpuinfoMhz.begin(), m_cpuinfoMhz.end());
+    } else {
+        out.perCpuMhz.assign(m_fds.size(), 0.0);
+        for (size_t cpu = 0; cpu < m_fds.size(); ++cpu) {
+            long khz = 0;
+            if (m_fds[cpu] >= 0 && readKhz(m_fds[cpu], khz)) {
+                out.perCpuMhz[cpu] = khz / 1000.0;
+            }
+        }
+    }
+
+    out.minMhz = 0.0;
+    out.maxMhz = 0.0;
+    out.avgMhz = 0.0;
+    double sum = 0.0;
+    int counted = 0;
+    for (double mhz : out.perCpuMhz) {
+        if (mhz <= 0.0) continue;
+        out.minMhz = counted == 0 ? mhz : std::min(out.minMhz, mhz);
+        out.maxMhz = std::max(out.maxMhz, mhz);
+        sum += mhz;
+        ++counted;
+    }
+    if (counted > 0) {
+        out.avgMhz = sum / counted;
+    }
+}
+
+void CpuFreqSampler::readCpuinfo() {
+    m_samplesSinceCpuinfo = 0;
+    m_cpuinfoMhz.clear();
+    std::ifstream cpuinfo(m_cpuinfoPath);
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 7, "cpu MHz") != 0) continue;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        m_cpuinfoMhz.push_back(std::strtod(line.c_str() + colon + 1, nullptr));
+    }
+}
@@ -0,0 +1,106 @@
+#include "headers/CpuGridWidget.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QResizeEvent>
+#include <algorithm>
+
+CpuGridWidget::CpuGridWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void CpuGridWidget::addSample(const std::vector<double>& perCpuUsagePercent)
+{
+    int count = static_cast<int>(perCpuUsagePercent.size());
+    if (count != m_cpuCount) {
+        // CPUs came online or went offline; start the histories over.
+        m_cpuCount = count;
+        m_history.assign(static_cast<size_t>(count) * kHistory, 0.0f);
+        m_head = 0;
+        m_filled = 0;
+        updateMinimumHeight();
+    }
+
+    for (int cpu = 0; cpu < count; ++cpu) {
+        m_history[static_cast<size_t>(cpu) * kHistory + m_head] =
+            static_cast<float>(std::clamp(perCpuUsagePercent[cpu], 0.0, 100.0));
+    }
+    m_head = (m_head + 1) % kHistory;
+    m_filled = std::min(m_filled + 1, kHistory);
+
+    if (isVisible()) {
+        update();
+    }
+}
+
+void CpuGridWidget::clear()
+{
+    m_head = 0;
+    m_filled = 0;
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    update();
+}
+
+int CpuGridWidget::columns() const
+{
+    return std::max(1, (width() + kSpacing) / (kCellWidth + kSpacing));
+}
+
+void CpuGridWidget::updateMinimumHeight()
+{
+    int cols = columns();
+    int rows = (m_cpuCount + cols - 1) / cols;
+    setMinimumHeight(rows > 0 ? rows * (kCellHeight + kSpacing) - kSpacing : 0);
+}
+
+void CpuGridWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updateMinimumHeight();
+}
+
+void CpuGridWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().window());
+
+    const QColor lineColor(17, 125, 187);
+    const QColor fillColor(17, 125, 187, 60);
+    const QColor borderColor(17, 125, 187, 120);
+
+    int cols = columns();
+    // Stretch the cells to use the whole row.
+    double cellWidth = (width() - (cols - 1) * kSpacing) / static_cast<double>(cols);
+    double step = cellWidth / (kHistory - 1);
+
+    for (int cpu = 0; cpu < m_cpuCount; ++cpu) {
+        QRectF cell((cpu % cols) * (cellWidth + kSpacing),
+                    (cpu / cols) * (kCellHeight + kSpacing),
+                    cellWidth, kCellHeight);
+        painter.fillRect(cell, Qt::white);
+
+        if (m_filled > 1) {
+            const float* ring = m_history.data() + static_cast<size_t>(cpu) * kHistory;
+            int oldest = (m_head - m_filled + kHistory) % kHistory;
+            double x = cell.right() - (m_filled - 1) * step;
+
+            QPainterPath path;
+            path.moveTo(x, cell.bottom());
+            for (int i = 0; i < m_filled; ++i, x += step) {
+                float value = ring[(oldest + i) % kHistory];
+                path.lineTo(x, cell.bottom() - value / 100.0 * cell.height());
+            }
+            path.lineTo(cell.right(), cell.bottom());
+
+            painter.fillPath(path, fillColor);
+            painter.setPen(lineColor);
+            painter.drawPath(path);
+        }
+
+        painter.setPen(borderColor);
+        painter.drawRect(cell.adjusted(0, 0, -1, -1));
+        painter.setPen(Qt::darkGray);
+        painter.drawText(cell.adjusted(3, 1, 0, 0), Qt::AlignLeft | Qt::AlignTop, QString::number(cpu));
+    }
+}
@@ -0,0 +1,92 @@
+#include "headers/CpuHeatmapWidget.h"
+#include <QHelpEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <algorithm>
+
+CpuHeatmapWidget::CpuHeatmapWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    QSizePolicy policy(QSizePolicy::Preferred, QSizePolicy::Fixed);
+    policy.setHeightForWidth(true);
+    setSizePolicy(policy);
+}
+
+void CpuHeatmapWidget::setFrequencies(const std::vector<double>& perCpuMhz, double scaleMhz)
+{
+    bool resized = perCpuMhz.size() != m_mhz.size();
+    m_mhz = perCpuMhz;
+    m_scaleMhz = scaleMhz;
+    for (double mhz : m_mhz) {
+        m_seenMaxMhz = std::max(m_seenMaxMhz, mhz);
+    }
+    if (resized) {
+        updateGeometry();
+    }
+    update();
+}
+
+int CpuHeatmapWidget::columns(int width) const
+{
+    return std::max(1, (width + kSpacing) / (kCell + kSpacing));
+}
+
+int CpuHeatmapWidget::heightForWidth(int width) const
+{
+    int cols = columns(width);
+    int rows = (static_cast<int>(m_mhz.size()) + cols - 1) / cols;
+    return std::max(1, rows) * (kCell + kSpacing) - kSpacing;
+}
+
+QSize CpuHeatmapWidget::sizeHint() const
+{
+    return QSize(16 * (kCell + kSpacing), heightForWidth(width()));
+}
+
+int CpuHeatmapWidget::cpuAt(const QPoint& pos) const
+{
+    int col = pos.x() / (kCell + kSpacing);
+    int row = pos.y() / (kCell + kSpacing);
+    int cols = columns(width());
+    if (col >= cols) return -1;
+    int cpu = row * cols + col;
+    return cpu < static_cast<int>(m_mhz.size()) ? cpu : -1;
+}
+
+bool CpuHeatmapWidget::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *help = static_cast<QHelpEvent*>(event);
+        int cpu = cpuAt(help->pos());
+        if (cpu >= 0) {
+            QString text = m_mhz[cpu] > 0.0
+                ? QString("CPU %1: %2 GHz").arg(cpu).arg(m_mhz[cpu] / 1000.0, 0, 'f', 2)
+                : QString("CPU %1: offline").arg(cpu);
+            QToolTip::showText(help->globalPos(), text, this);
+        } else {
+            QToolTip::hideText();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+void CpuHeatmapWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    double scale = m_scaleMhz > 0.0 ? m_scaleMhz : m_seenMaxMhz;
+    int cols = columns(width());
+
+    for (size_t cpu = 0; cpu < m_mhz.size(); ++cpu) {
+        QRect cell(static_cast<int>(cpu % cols) * (kCell + kSpacing),
+                   static_cast<int>(cpu / cols) * (kCell + kSpacing),
+                   kCell, kCell);
+        QColor color(Qt::lightGray);
+        if (m_mhz[cpu] > 0.0 && scale > 0.0) {
+            // Blue when idle-clocked, through yellow, to red at the scale.
+            double heat = std::clamp(m_mhz[cpu] / scale, 0.0, 1.0);
+            color = QColor::fromHsvF((1.0 - heat) * 240.0 / 360.0, 0.8, 0.9);
+        }
+        painter.fillRect(cell, color);
+    }
+}
@@ -0,0 +1,169 @@
+#include "headers/CpuTopology.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <map>
+
+// Number after a prefix such as "cpu12" or "node1", or -1.
+static int indexedName(const char* name, const char* prefix) {
+    size_t len = std::strlen(prefix);
+    if (std::strncmp(name, prefix, len) != 0 || name[len] == '\0') {
+        return -1;
+    }
+    for (const char* p = name + len; *p; ++p) {
+        if (*p < '0' || *p > '9') return -1;
+    }
+    return std::atoi(name + len);
+}
+
+static bool readInt(const std::string& path, int& value) {
+    std::ifstream file(path);
+    return static_cast<bool>(file >> value);
+}
+
+// Parses the kernel's cpulist format, e.g. "0-3,8-11".
+static std::vector<int> readCpuList(const std::string& path) {
+    std::vector<int> cpus;
+    std::ifstream file(path);
+    std::string list;
+    if (!std::getline(file, list)) {
+        return cpus;
+    }
+    const char* p = list.c_str();
+    while (*p) {
+        char* end = nullptr;
+        long first = std::strtol(p, &end, 10);
+        if (end == p) break;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = std::strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        if (*p == ',') ++p;
+        else break;
+    }
+    return cpus;
+}
+
+static std::vector<int> listIndexed(const std::string& dirPath, const char* prefix) {
+    std::vector<int> indices;
+    DIR* dir = opendir(dirPath.c_str());
+    if (!dir) {
+        return indices;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        int index = indexedName(entry->d_name, prefix);
+        if (index >= 0) indices.push_back(index);
+    }
+    closedir(dir);
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+CpuTopology CpuTopology::read(const SystemRoots& roots) {
+    CpuTopology topology;
+    std::string cpuRoot = roots.sys + "/devices/system/cpu";
+
+    std::vector<int> cpuNumbers = listIndexed(cpuRoot, "cpu");
+    if (cpuNumbers.empty()) {
+        return topology;
+    }
+    topology.cpus.resize(cpuNumbers.back() + 1);
+
+    std::vector<int> online = readCpuList(cpuRoot + "/online");
+    std::map<int, int> socketIndex;
+    std::map<std::pair<int, int>, int> coreIndex;
+    for (int cpu : cpuNumbers) {
+        Cpu& entry = topology.cpus[cpu];
+        std::string topologyDir = cpuRoot + "/cpu" + std::to_string(cpu) + "/topology/";
+        int packageId = 0, coreId = 0;
+        // Offline CPUs have no topology directory.
+        if (!readInt(topologyDir + "physical_package_id", packageId)) {
+            continue;
+        }
+        if (!readInt(topologyDir + "core_id", coreId)) {
+            coreId = cpu;
+        }
+        entry.online = online.empty() || std::find(online.begin(), online.end(), cpu) != online.end();
+
+        auto socket = socketIndex.emplace(packageId, static_cast<int>(socketIndex.size())).first;
+        if (socket->second == static_cast<int>(topology.socketIds.size())) {
+            topology.socketIds.push_back(packageId);
+        }
+        entry.socket = socket->second;
+        entry.core = coreIndex.emplace(std::make_pair(packageId, coreId),
+                                       static_cast<int>(coreIndex.size())).first->second;
+    }
+    topology.coreCount = static_cast<int>(coreIndex.size());
+
+    std::string nodeRoot = roots.sys + "/devices/system/node";
+    for (int node : listIndexed(nodeRoot, "node")) {
+        for (int cpu : readCpuList(nodeRoot + "/node" + std::to_string(node) + "/cpulist")) {
+            if (cpu >= 0 && cpu < static_cast<int>(topology.cpus.size())) {
+                topology.cpus[cpu].node = node;
+            }
+        }
+        topology.nodeCount = std::max(topology.nodeCount, node + 1);
+    }
+    // Kernels built without NUMA have no node directory: everything is node 0.
+    if (topology.nodeCount == 0) {
+        topology.nodeCount = 1;
+        for (Cpu& cpu : topology.cpus) {
+            if (cpu.socket >= 0) cpu.node = 0;
+        }
+    }
+    return topology;
+}
+
+int CpuTopology::onlineCount() const {
+    return static_cast<int>(std::count_if(cpus.begin(), cpus.end(),
+                                          [](const Cpu& cpu) { return cpu.online; }));
+}
+
+int CpuTopology::nodeOf(int cpu) const {
+    if (cpu < 0 || cpu >= static_cast<int>(cpus.size())) {
+        return -1;
+    }
+    return cpus[cpu].node;
+}
+
+std::vector<int> CpuTopology::siblingsOf(int cpu) const {
+    std::vector<int> siblings;
+    if (cpu < 0 || cpu >= static_cast<int>(cpus.size()) || cpus[cpu].core < 0) {
+        return siblings;
+    }
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        if (cpus[i].core == cpus[cpu].core) siblings.push_back(static_cast<int>(i));
+    }
+    return siblings;
+}
+
+static void averageBy(const std::vector<CpuTopology::Cpu>& cpus, int CpuTopology::Cpu::*group,
+                      size_t groups, const std::vector<double>& perCpu, std::vector<double>& out) {
+    out.assign(groups, 0.0);
+    std::vector<int> counts(groups, 0);
+    size_t count = std::min(cpus.size(), perCpu.size());
+    for (size_t cpu = 0; cpu < count; ++cpu) {
+        int index = cpus[cpu].*group;
+        if (!cpus[cpu].online || index < 0 || static_cast<size_t>(index) >= groups) continue;
+        out[index] += perCpu[cpu];
+        counts[index]++;
+    }
+    for (size_t i = 0; i < groups; ++i) {
+        if (counts[i] > 0) out[i] /= counts[i];
+    }
+}
+
+void CpuTopology::averageBySocket(const std::vector<double>& perCpu, std::vector<double>& out) const {
+    averageBy(cpus, &Cpu::socket, socketIds.size(), perCpu, out);
+}
+
+void CpuTopology::averageByNode(const std::vector<double>& perCpu, std::vector<double>& out) const {
+    averageBy(cpus, &Cpu::node, static_cast<size_t>(nodeCount), perCpu, out);
+}
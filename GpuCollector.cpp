@@ -0,0 +1,81 @@
+#include "headers/GpuCollector.h"
+#include <QDebug>
+#include <stdexcept>
+
+GpuCollector::GpuCollector(int intervalMs)
+    : m_intervalMs(intervalMs)
+{
+}
+
+GpuCollector::~GpuCollector() = default;
+
+void GpuCollector::start()
+{
+    // Probing opens the sysfs files, so it happens in the collector thread too.
+    m_sampler.reset(new GpuSampler());
+
+    m_timer = new QTimer(this);
+    connect(m_timer, &QTimer::timeout, this, &GpuCollector::sampleNow);
+
+    applySettings();
+}
+
+void GpuCollector::setActive(bool active)
+{
+    if (m_active.exchange(active) != active) {
+        QMetaObject::invokeMethod(this, "applySettings", Qt::QueuedConnection);
+    }
+}
+
+void GpuCollector::setIntervalMs(int intervalMs)
+{
+    if (m_intervalMs.exchange(intervalMs) != intervalMs) {
+        QMetaObject::invokeMethod(this, "applySettings", Qt::QueuedConnection);
+    }
+}
+
+std::shared_ptr<const std::vector<GpuSample>> GpuCollector::takeLatest()
+{
+    m_pending.store(false);
+    return std::atomic_load(&m_latest);
+}
+
+void GpuCollector::applySettings()
+{
+    if (!m_timer) {
+        return;
+    }
+
+    if (!m_active.load()) {
+        m_timer->stop();
+        return;
+    }
+
+    bool wasRunning = m_timer->isActive();
+    m_timer->start(m_intervalMs.load());
+    if (!wasRunning) {
+        sampleNow();
+    }
+}
+
+void GpuCollector::sampleNow()
+{
+    if (!m_sampler) {
+        return;
+    }
+
+    // Published vectors are shared with the UI, so each tick fills a new one.
+    auto samples = std::make_shared<std::vector<GpuSample>>();
+    try {
+        m_sampler->sample(*samples);
+    } catch (const std::exception& e) {
+        qWarning() << "GPU sampling failed:" << e.what();
+        return;
+    }
+
+    std::atomic_store(&m_latest, std::shared_ptr<const std::vector<GpuSample>>(std::move(samples)));
+
+    if (!m_pending.exchange(true)) {
+        emit sampleReady();
+    }
+}
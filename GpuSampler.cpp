@@ -0,0 +1,354 @@
+#include "headers/GpuSampler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// sysfs attributes are a few bytes long and can be re-read from offset 0, so
+// each one is opened once at probe time and then only pread.
+static bool readSysfsNumber(int fd, long long& value) {
+    if (fd < 0) {
+        return false;
+    }
+    char buf[32];
+    ssize_t len = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (len <= 0) {
+        return false;
+    }
+    buf[len] = '\0';
+    char* end = nullptr;
+    value = std::strtoll(buf, &end, 10);
+    return end != buf;
+}
+
+// Leading number of a cell such as "37", "54.0" or "12 %"; "N/A" fails.
+static bool parseCell(const std::string& cell, double& value) {
+    char* end = nullptr;
+    value = std::strtod(cell.c_str(), &end);
+    return end != cell.c_str();
+}
+
+static std::string readSysfsLine(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+static bool isCardName(const char* name) {
+    if (std::strncmp(name, "card", 4) != 0 || name[4] == '\0') {
+        return false;
+    }
+    for (const char* p = name + 4; *p; ++p) {
+        if (*p < '0' || *p > '9') return false;
+    }
+    return true;
+}
+
+// cardN entries in PCI order, without the connector entries (card0-DP-1).
+static std::vector<std::string> listCards(const std::string& drmRoot) {
+    std::vector<std::string> cards;
+    DIR* dir = opendir(drmRoot.c_str());
+    if (!dir) {
+        return cards;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        if (isCardName(entry->d_name)) {
+            cards.push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(cards.begin(), cards.end(), [](const std::string& a, const std::string& b) {
+        return std::atoi(a.c_str() + 4) < std::atoi(b.c_str() + 4);
+    });
+    return cards;
+}
+
+static std::string findHwmon(const std::string& deviceDir) {
+    std::string hwmonRoot = deviceDir + "/hwmon";
+    DIR* dir = opendir(hwmonRoot.c_str());
+    if (!dir) {
+        return std::string();
+    }
+    std::string found;
+    while (struct dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, "hwmon", 5) == 0) {
+            found = hwmonRoot + "/" + entry->d_name;
+            break;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+// Where each driver keeps the counters that are not on its hwmon node. Paths
+// are relative to /sys/class/drm/cardN; null means the driver has none.
+struct DriverFiles {
+    const char* driver;
+    const char* vendor;
+    const char* busy;       // percent
+    const char* vramTotal;  // bytes
+    const char* vramUsed;   // bytes
+    const char* clock;      // MHz
+};
+
+static const DriverFiles kDrivers[] = {
+    {"amdgpu",  "AMD",    "device/gpu_busy_percent", "device/mem_info_vram_total",
+                          "device/mem_info_vram_used", nullptr},
+    {"i915",    "Intel",  nullptr, nullptr, nullptr, "gt_act_freq_mhz"},
+    {"xe",      "Intel",  nullptr, nullptr, nullptr, "device/tile0/gt0/freq0/act_freq"},
+    {"nouveau", "NVIDIA", nullptr, nullptr, nullptr, nullptr},
+};
+
+static const DriverFiles* driverFiles(const std::string& name) {
+    for (const DriverFiles& driver : kDrivers) {
+        if (name == driver.driver) return &driver;
+    }
+    return nullptr;
+}
+
+static const DriverFiles* findDriver(const std::string& cardDir) {
+    std::ifstream uevent(cardDir + "/device/uevent");
+    std::string line;
+    while (std::getline(uevent, line)) {
+        if (line.compare(0, 7, "DRIVER=") != 0) {
+            continue;
+        }
+        return driverFiles(line.substr(7));
+    }
+    return nullptr;
+}
+
+static std::vector<GpuDevice> enumerateCards(const std::string& drmRoot) {
+    std::vector<GpuDevice> devices;
+    for (const std::string& card : listCards(drmRoot)) {
+        std::string cardDir = drmRoot + "/" + card;
+        const DriverFiles* driver = findDriver(cardDir);
+        if (!driver) {
+            continue;
+        }
+        GpuDevice device;
+        device.card = card;
+        device.driver = driver->driver;
+        device.vendor = driver->vendor;
+        device.name = readSysfsLine(cardDir + "/device/product_name");
+        if (device.name.empty()) {
+            device.name = device.vendor + " GPU " + readSysfsLine(cardDir + "/device/device");
+        }
+        devices.push_back(device);
+    }
+    return devices;
+}
+
+static int openOptional(const std::string& dir, const char* relative) {
+    if (!relative || dir.empty()) {
+        return -1;
+    }
+    return open((dir + "/" + relative).c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+// Reads every supported card straight from sysfs. Utilisation, VRAM and clock
+// come from the driver's own attributes, temperature, fan and power from its
+// hwmon node, which all of these drivers register.
+class SysfsGpuBackend : public GpuBackend {
+public:
+    explicit SysfsGpuBackend(std::string drmRoot) : m_drmRoot(std::move(drmRoot)) {}
+
+    ~SysfsGpuBackend() override {
+        for (Card& card : m_cards) {
+            for (int fd : card.fds) {
+                if (fd >= 0) close(fd);
+            }
+        }
+    }
+
+    const char* name() const override { return "sysfs"; }
+
+    bool probe() override {
+        for (const GpuDevice& device : enumerateCards(m_drmRoot)) {
+            std::string cardDir = m_drmRoot + "/" + device.card;
+            const DriverFiles* driver = driverFiles(device.driver);
+
+            Card card;
+            card.device = device;
+            card.fds[FileBusy] = openOptional(cardDir, driver->busy);
+            card.fds[FileVramTotal] = openOptional(cardDir, driver->vramTotal);
+            card.fds[FileVramUsed] = openOptional(cardDir, driver->vramUsed);
+            card.fds[FileClock] = openOptional(cardDir, driver->clock);
+
+            std::string hwmon = findHwmon(cardDir + "/device");
+            card.fds[FileTemp] = openOptional(hwmon, "temp1_input");
+            card.fds[FileFan] = openOptional(hwmon, "fan1_input");
+            card.fds[FilePower] = openOptional(hwmon, "power1_average");
+            if (card.fds[FilePower] < 0) {
+                card.fds[FilePower] = openOptional(hwmon, "power1_input");
+            }
+            // Intel's discrete cards only publish an energy counter.
+            if (card.fds[FilePower] < 0) {
+                card.fds[FileEnergy] = openOptional(hwmon, "energy1_input");
+            }
+            // amdgpu reports its shader clock on hwmon, in Hz.
+            if (card.fds[FileClock] < 0) {
+                card.fds[FileClockHz] = openOptional(hwmon, "freq1_input");
+            }
+            m_cards.push_back(card);
+        }
+        return !m_cards.empty();
+    }
+
+    void sample(std::vector<GpuSample>& out) override {
+        auto now = std::chrono::steady_clock::now();
+        for (Card& card : m_cards) {
+            out.emplace_back();
+            GpuSample& sample = out.back();
+            sample.card = card.device.card;
+            sample.deviceName = card.device.name;
+            sample.vendor = card.device.vendor;
+
+            long long value = 0;
+            if (readSysfsNumber(card.fds[FileBusy], value)) {
+                sample.busyPercent = static_cast<double>(value);
+                sample.valid |= GpuUsage;
+            }
+            if (readSysfsNumber(card.fds[FileVramTotal], value)) {
+                sample.vramTotalBytes = static_cast<uint64_t>(value);
+                sample.valid |= GpuVramTotal;
+            }
+            if (readSysfsNumber(card.fds[FileVramUsed], value)) {
+                sample.vramUsedBytes = static_cast<uint64_t>(value);
+                sample.valid |= GpuVramUsed;
+            }
+            if (readSysfsNumber(card.fds[FileClock], value)) {
+                sample.clockMhz = static_cast<double>(value);
+                sample.valid |= GpuClock;
+            } else if (readSysfsNumber(card.fds[FileClockHz], value)) {
+                sample.clockMhz = value / 1000000.0;
+                sample.valid |= GpuClock;
+            }
+            if (readSysfsNumber(card.fds[FileTemp], value)) {
+                sample.temperatureC = value / 1000.0;       // millidegrees
+                sample.valid |= GpuTemperature;
+            }
+            if (readSysfsNumber(card.fds[FileFan], value)) {
+                sample.fanRpm = static_cast<double>(value);
+                sample.valid |= GpuFan;
+            }
+            if (readSysfsNumber(card.fds[FilePower], value)) {
+                sample.powerWatts = value / 1000000.0;      // microwatts
+                sample.valid |= GpuPower;
+            } else if (readSysfsNumber(card.fds[FileEnergy], value)) {
+                // Microjoules; the first reading only sets the baseline.
+                if (card.prevEnergy >= 0 && value >= card.prevEnergy) {
+                    double seconds = std::chrono::duration<double>(now - card.prevEnergyTime).count();
+                    if (seconds > 0.0) {
+                        sample.powerWatts = (value - card.prevEnergy) / 1000000.0 / seconds;
+                        sample.valid |= GpuPower;
+                    }
+                }
+                card.prevEnergy = value;
+                card.prevEnergyTime = now;
+            }
+        }
+    }
+
+private:
+    enum File {
+        FileBusy, FileVramTotal, FileVramUsed, FileClock, FileClockHz,
+        FileTemp, FileFan, FilePower, FileEnergy, FileCount
+    };
+
+    struct Card {
+        GpuDevice device;
+        int fds[FileCount] = {-1, -1, -1, -1, -1, -1, -1, -1, -1};
+        long long prevEnergy = -1;
+        std::chrono::steady_clock::time_point prevEnergyTime;
+    };
+
+    std::string m_drmRoot;
+    std::vector<Card> m_cards;
+};
+
+// Forks rocm-smi on every sample, so it is only used when sysfs shows no card
+// we can read. Its CSV output is parsed for a single card.
+class RocmSmiBackend : public GpuBackend {
+public:
+    explicit RocmSmiBackend(const SystemRoots& roots) : m_parser(roots) {}
+
+    const char* name() const override { return "rocm-smi"; }
+    bool probe() override { return m_parser.isRocmSmiAvailable(); }
+
+    // The parser hands back rocm-smi's CSV cells as text; they are converted
+    // here once so nothing downstream parses strings.
+    void sample(std::vector<GpuSample>& samples) override {
+        samples.emplace_back();
+        GpuSample& out = samples.back();
+        AmdGpuInfo info = m_parser.getAmdGpuStats();
+        if (info.deviceName != "N/A") {
+            out.deviceName = info.deviceName;
+        }
+        out.vendor = info.vendor;
+
+        double value = 0.0;
+        if (parseCell(info.gpuUsage, value)) {
+            out.busyPercent = value;
+            out.valid |= GpuUsage;
+        }
+        if (parseCell(info.vramTotal, value)) {
+            out.vramTotalBytes = static_cast<uint64_t>(value);  // rocm-smi reports bytes
+            out.valid |= GpuVramTotal;
+        }
+        if (parseCell(info.vramUsed, value)) {
+            out.vramUsedBytes = static_cast<uint64_t>(value);
+            out.valid |= GpuVramUsed;
+        }
+        if (parseCell(info.gpuTemp, value)) {
+            out.temperatureC = value;
+            out.valid |= GpuTemperature;
+        }
+        if (parseCell(info.fanSpeed, value)) {
+            out.fanRpm = value;
+            out.valid |= GpuFan;
+        }
+        if (parseCell(info.powerUsage, value)) {
+            out.powerWatts = value;
+            out.valid |= GpuPower;
+        }
+    }
+
+private:
+    ProcessParser m_parser;
+};
+
+GpuSampler::GpuSampler(const SystemRoots& roots, bool allowRocmSmi) {
+    std::unique_ptr<GpuBackend> sysfs(new SysfsGpuBackend(roots.sys + "/class/drm"));
+    if (sysfs->probe()) {
+        m_backend = std::move(sysfs);
+        return;
+    }
+    if (allowRocmSmi) {
+        std::unique_ptr<GpuBackend> rocmSmi(new RocmSmiBackend(roots));
+        if (rocmSmi->probe()) {
+            m_backend = std::move(rocmSmi);
+        }
+    }
+}
+
+GpuSampler::~GpuSampler() = default;
+
+std::vector<GpuDevice> GpuSampler::enumerate(const SystemRoots& roots) {
+    return enumerateCards(roots.sys + "/class/drm");
+}
+
+void GpuSampler::sample(std::vector<GpuSample>& out) {
+    out.clear();
+    if (m_backend) {
+        m_backend->sample(out);
+    }
+}
+
+const char* GpuSampler::backendName() const {
+    return m_backend ? m_backend->name() : "none";
+}
@@ -0,0 +1,79 @@
+#include "headers/MemoryCompositionBar.h"
+#include <QHelpEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <algorithm>
+
+MemoryCompositionBar::MemoryCompositionBar(QWidget *parent)
+    : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    setMinimumHeight(20);
+}
+
+void MemoryCompositionBar::setMemInfo(const MemInfo &info)
+{
+    // Cached includes shmem and dirty pages; they are drawn separately and
+    // taken out of it. Reclaimable slab counts as cache, as free(1) does.
+    long hugePagesKb = info.hugePagesTotal * info.hugePageSizeKb;
+    long shared = std::min(info.shmem, info.cached);
+    long modified = std::min(info.dirty + info.writeback, info.cached - shared);
+    long cached = info.cached + info.buffers + info.sReclaimable - shared - modified;
+    long inUse = info.memTotal - info.memFree - cached - shared - modified - hugePagesKb;
+
+    m_totalKb = info.memTotal;
+    m_segments = {
+        {"In use", QColor(139, 18, 174), std::max(0L, inUse)},
+        {"Huge pages", QColor(90, 40, 120), std::max(0L, hugePagesKb)},
+        {"Shared", QColor(190, 90, 200), std::max(0L, shared)},
+        {"Modified", QColor(200, 120, 60), std::max(0L, modified)},
+        {"Cached", QColor(200, 170, 215), std::max(0L, cached)},
+        {"Free", QColor(245, 245, 245), std::max(0L, info.memFree)},
+    };
+    update();
+}
+
+int MemoryCompositionBar::segmentAt(int x) const
+{
+    if (m_totalKb <= 0) return -1;
+    double left = 0.0;
+    for (int i = 0; i < m_segments.size(); ++i) {
+        double right = left + width() * static_cast<double>(m_segments[i].kb) / m_totalKb;
+        if (x >= left && x < right) return i;
+        left = right;
+    }
+    return -1;
+}
+
+bool MemoryCompositionBar::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *help = static_cast<QHelpEvent*>(event);
+        int index = segmentAt(help->pos().x());
+        if (index >= 0) {
+            const Segment &segment = m_segments[index];
+            QToolTip::showText(help->globalPos(), QString("%1: %2 MB")
+                .arg(segment.name).arg(segment.kb / 1024), this);
+        } else {
+            QToolTip::hideText();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+void MemoryCompositionBar::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    QRectF bar(0, 0, width() - 1, height() - 1);
+    if (m_totalKb > 0) {
+        double left = 0.0;
+        for (const Segment &segment : m_segments) {
+            double segmentWidth = bar.width() * static_cast<double>(segment.kb) / m_totalKb;
+            painter.fillRect(QRectF(left, 0, segmentWidth, bar.height()), segment.color);
+            left += segmentWidth;
+        }
+    }
+    painter.setPen(QColor(139, 18, 174));
+    painter.drawRect(bar);
+}
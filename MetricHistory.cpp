@@ -0,0 +1,74 @@
+#include "headers/MetricHistory.h"
+#include <algorithm>
+#include <limits>
+
+double MetricHistory::resolution(HistoryTier tier) {
+    switch (tier) {
+        case TierSeconds: return 1.0;
+        case TierTenSeconds: return 10.0;
+        default: return 60.0;
+    }
+}
+
+double MetricHistory::span(HistoryTier tier) {
+    switch (tier) {
+        case TierSeconds: return 10 * 60.0;
+        case TierTenSeconds: return 6 * 3600.0;
+        default: return 7 * 86400.0;
+    }
+}
+
+HistoryTier MetricHistory::tierFor(double spanSeconds) {
+    if (spanSeconds <= span(TierSeconds)) return TierSeconds;
+    if (spanSeconds <= span(TierTenSeconds)) return TierTenSeconds;
+    return TierMinutes;
+}
+
+void MetricHistory::add(double time, double value) {
+    HistoryPoint point;
+    point.time = time;
+    point.min = point.avg = point.max = static_cast<float>(value);
+    m_seconds.push(point);
+    ++m_revisions[TierSeconds];
+
+    accumulate(TierTenSeconds, m_tenSecondBucket, time, value);
+    accumulate(TierMinutes, m_minuteBucket, time, value);
+}
+
+void MetricHistory::accumulate(HistoryTier tier, OpenBucket& bucket, double time, double value) {
+    double width = resolution(tier);
+    double start = std::floor(time / width) * width;
+    if (bucket.open && start != bucket.start) {
+        close(tier, bucket);
+        bucket = OpenBucket();
+    }
+    if (!bucket.open) {
+        bucket.open = true;
+        bucket.start = start;
+    }
+    if (std::isnan(value)) {
+        return;
+    }
+    bucket.min = bucket.count == 0 ? value : std::min(bucket.min, value);
+    bucket.max = bucket.count == 0 ? value : std::max(bucket.max, value);
+    bucket.sum += value;
+    ++bucket.count;
+}
+
+void MetricHistory::close(HistoryTier tier, const OpenBucket& bucket) {
+    HistoryPoint point;
+    point.time = bucket.start;
+    if (bucket.count == 0) {
+        point.min = point.avg = point.max = std::numeric_limits<float>::quiet_NaN();
+    } else {
+        point.min = static_cast<float>(bucket.min);
+        point.avg = static_cast<float>(bucket.sum / bucket.count);
+        point.max = static_cast<float>(bucket.max);
+    }
+    if (tier == TierTenSeconds) {
+        m_tenSeconds.push(point);
+    } else {
+        m_minutes.push(point);
+    }
+    ++m_revisions[tier];
+}
@@ -0,0 +1,335 @@
+#include "headers/MetricJournal.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char kJournalMagic[8] = {'G', 'T', 'M', 'J', 'R', 'N', 'L', '\0'};
+static const uint32_t kJournalVersion = 4;
+static const size_t kHeaderSize = 4096;
+static const size_t kDiskNameSize = 64;
+
+struct JournalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t columnCount;
+    uint64_t sequence;      // ticks ever appended; the next goes to sequence % slotCount
+    char diskNames[kJournalDisks][kDiskNameSize];
+};
+static_assert(sizeof(JournalHeader) <= kHeaderSize, "journal header must fit its page");
+
+namespace {
+
+// Byte offsets of the sections after the header page, each 8-byte aligned.
+struct Layout {
+    size_t time = 0;
+    size_t slotSequence = 0;
+    size_t slotChecksum = 0;
+    size_t columns = 0;
+    size_t processes = 0;
+    size_t total = 0;
+};
+
+Layout layoutFor(uint32_t slots) {
+    Layout layout;
+    size_t at = kHeaderSize;
+    auto take = [&at](size_t bytes) {
+        size_t offset = at;
+        at = (at + bytes + 7) & ~static_cast<size_t>(7);
+        return offset;
+    };
+    layout.time = take(slots * sizeof(double));
+    layout.slotSequence = take(slots * sizeof(uint64_t));
+    layout.slotChecksum = take(slots * sizeof(uint32_t));
+    layout.columns = take(static_cast<size_t>(JournalColumnCount) * slots * sizeof(float));
+    layout.processes = take(static_cast<size_t>(kJournalProcesses) * slots * sizeof(JournalProcess));
+    layout.total = at;
+    return layout;
+}
+
+} // namespace
+
+MetricJournal::~MetricJournal() {
+    close();
+}
+
+bool MetricJournal::open(const std::string& path, uint32_t slotCount) {
+    close();
+    m_error.clear();
+    if (slotCount == 0) {
+        m_error = "invalid journal geometry";
+        return false;
+    }
+
+    auto fail = [this](const std::string& what) {
+        m_error = what + ": " + std::strerror(errno);
+        close();
+        return false;
+    };
+
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        return fail("cannot open " + path);
+    }
+    if (flock(m_fd, LOCK_EX | LOCK_NB) != 0) {
+        return fail("journal is in use");
+    }
+
+    Layout layout = layoutFor(slotCount);
+    struct stat st;
+    if (fstat(m_fd, &st) != 0) {
+        return fail("cannot stat " + path);
+    }
+
+    bool reuse = false;
+    if (static_cast<size_t>(st.st_size) == layout.total) {
+        JournalHeader header;
+        reuse = pread(m_fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+                && std::memcmp(header.magic, kJournalMagic, sizeof(kJournalMagic)) == 0
+                && header.version == kJournalVersion
+                && header.slotCount == slotCount
+                && header.columnCount == JournalColumnCount;
+    }
+    if (!reuse) {
+        // Reserve every block up front so a full disk fails here rather than
+        // as SIGBUS on a later store into the mapping.
+        if (ftruncate(m_fd, 0) != 0 || ftruncate(m_fd, static_cast<off_t>(layout.total)) != 0) {
+            return fail("cannot size " + path);
+        }
+        int err = posix_fallocate(m_fd, 0, static_cast<off_t>(layout.total));
+        if (err != 0) {
+            errno = err;
+            return fail("cannot allocate " + path);
+        }
+    }
+
+    void* map = mmap(nullptr, layout.total, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) {
+        return fail("cannot map " + path);
+    }
+    m_map = map;
+    m_mapSize = layout.total;
+    m_slotCount = slotCount;
+
+    char* base = static_cast<char*>(map);
+    m_header = reinterpret_cast<JournalHeader*>(base);
+    m_time = reinterpret_cast<double*>(base + layout.time);
+    m_slotSequence = reinterpret_cast<uint64_t*>(base + layout.slotSequence);
+    m_slotChecksum = reinterpret_cast<uint32_t*>(base + layout.slotChecksum);
+    m_columns = reinterpret_cast<float*>(base + layout.columns);
+    m_processes = reinterpret_cast<JournalProcess*>(base + layout.processes);
+
+    if (!reuse) {
+        std::memcpy(m_header->magic, kJournalMagic, sizeof(kJournalMagic));
+        m_header->version = kJournalVersion;
+        m_header->slotCount = slotCount;
+        m_header->columnCount = JournalColumnCount;
+        m_header->sequence = 0;
+        msync(m_map, kHeaderSize, MS_SYNC);
+    }
+
+    m_stopping = false;
+    m_flushPending = false;
+    m_flusher = std::thread(&MetricJournal::flushLoop, this);
+    return true;
+}
+
+void MetricJournal::close() {
+    if (m_flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_flushMutex);
+            m_stopping = true;
+        }
+        m_flushWake.notify_one();
+        m_flusher.join();
+    }
+    if (m_map) {
+        msync(m_map, m_mapSize, MS_SYNC);
+        munmap(m_map, m_mapSize);
+        m_map = nullptr;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);  // drops the flock
+        m_fd = -1;
+    }
+    m_mapSize = 0;
+    m_slotCount = 0;
+    m_header = nullptr;
+    m_time = nullptr;
+    m_slotSequence = nullptr;
+    m_slotChecksum = nullptr;
+    m_columns = nullptr;
+    m_processes = nullptr;
+}
+
+uint64_t MetricJournal::sequence() const {
+    return m_header ? m_header->sequence : 0;
+}
+
+size_t MetricJournal::size() const {
+    return static_cast<size_t>(std::min<uint64_t>(sequence(), m_slotCount));
+}
+
+// FNV-1a over the slot's sequence, time, every column and its processes.
+// The columns of one slot are spread over as many pages, which is what can
+// tear.
+uint32_t MetricJournal::checksum(size_t slot, uint64_t seq) const {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+    };
+    mix(&seq, sizeof(seq));
+    mix(&m_time[slot], sizeof(double));
+    for (unsigned column = 0; column < JournalColumnCount; ++column) {
+        mix(&m_columns[column * m_slotCount + slot], sizeof(float));
+    }
+    mix(processes(slot), kJournalProcesses * sizeof(JournalProcess));
+    return hash;
+}
+
+void MetricJournal::clearDisk(unsigned disk) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    uint64_t end = sequence();
+    for (uint64_t seq = end - size(); seq < end; ++seq) {
+        size_t slot = static_cast<size_t>(seq % m_slotCount);
+        if (m_slotSequence[slot] != seq + 1) continue;
+        // A slot that already fails its checksum is left to fail it.
+        bool intact = m_slotChecksum[slot] == checksum(slot, seq);
+        for (unsigned field = 0; field < 3; ++field) {
+            m_columns[journalDiskColumn(disk, field) * m_slotCount + slot] = nan;
+        }
+        if (intact) {
+            m_slotChecksum[slot] = checksum(slot, seq);
+        }
+    }
+}
+
+void MetricJournal::storeProcesses(const StatsSnapshot& snapshot, JournalProcess* rows) {
+    std::memset(rows, 0, kJournalProcesses * sizeof(JournalProcess));
+    if (!(snapshot.metrics & MetricProcesses)) {
+        return;
+    }
+
+    const std::vector<ProcessRow>& all = snapshot.processes;
+    size_t top = std::min<size_t>(kJournalTopProcesses, all.size());
+    size_t used = 0;
+    m_order.resize(all.size());
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < all.size(); ++i) m_order[i] = i;
+        std::partial_sort(m_order.begin(), m_order.begin() + static_cast<std::ptrdiff_t>(top), m_order.end(),
+                          [&all, pass](size_t a, size_t b) {
+                              return pass == 0 ? all[a].cpuPercent > all[b].cpuPercent
+                                               : all[a].memoryKb > all[b].memoryKb;
+                          });
+        for (size_t i = 0; i < top; ++i) {
+            const ProcessRow& row = all[m_order[i]];
+            // An idle machine has no top by CPU, only a pick among zeros.
+            if (pass == 0 ? row.cpuPercent <= 0.0 : row.memoryKb <= 0) break;
+            bool stored = false;
+            for (size_t j = 0; j < used && !stored; ++j) {
+                stored = rows[j].pid == row.pid;
+            }
+            if (stored) continue;
+
+            JournalProcess& out = rows[used++];
+            out.pid = row.pid;
+            out.cpuPercent = static_cast<float>(row.cpuPercent);
+            out.memoryKb = row.memoryKb;
+            std::memcpy(out.name, row.name, strnlen(row.name, sizeof(row.name) - 1));
+            if (row.owner) {
+                std::memcpy(out.owner, row.owner->data(), std::min(row.owner->size(), sizeof(out.owner) - 1));
+            }
+        }
+    }
+}
+
+std::string MetricJournal::diskName(unsigned disk) const {
+    if (!m_header || disk >= kJournalDisks) {
+        return std::string();
+    }
+    const char* name = m_header->diskNames[disk];
+    return std::string(name, strnlen(name, kDiskNameSize));
+}
+
+void MetricJournal::append(const StatsSnapshot& snapshot, const std::vector<std::string>& diskNames) {
+    if (!m_map) {
+        return;
+    }
+
+    // Blank a reassigned column before relabelling it, so a crash in
+    // between leaves old values under no name rather than the wrong one.
+    for (unsigned disk = 0; disk < kJournalDisks; ++disk) {
+        const char* name = disk < diskNames.size() ? diskNames[disk].c_str() : "";
+        char* stored = m_header->diskNames[disk];
+        if (strncmp(stored, name, kDiskNameSize - 1) != 0) {
+            clearDisk(disk);
+            std::memset(stored, 0, kDiskNameSize);
+            std::memcpy(stored, name, std::min(std::strlen(name), kDiskNameSize - 1));
+        }
+    }
+
+    uint64_t seq = m_header->sequence;
+    size_t slot = static_cast<size_t>(seq % m_slotCount);
+    // Invalid until every column of the slot holds the new tick.
+    m_slotSequence[slot] = 0;
+
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    auto set = [this, slot](JournalColumn column, double value) {
+        m_columns[column * m_slotCount + slot] = static_cast<float>(value);
+    };
+
+    m_time[slot] = snapshot.timestamp;
+    set(JournalCpuPercent, snapshot.cpuUsagePercent);
+    set(JournalMemPercent, snapshot.memUsagePercent);
+    set(JournalNetSendBits, snapshot.netSendBitsPerSec);
+    set(JournalNetRecvBits, snapshot.netRecvBitsPerSec);
+    for (unsigned disk = 0; disk < kJournalDisks; ++disk) {
+        bool present = disk < snapshot.disks.size();
+        const DiskSample* sample = present ? &snapshot.disks[disk] : nullptr;
+        set(journalDiskColumn(disk, 0), present ? sample->activePercent : nan);
+        set(journalDiskColumn(disk, 1), present ? sample->readBytesPerSec : nan);
+        set(journalDiskColumn(disk, 2), present ? sample->writeBytesPerSec : nan);
+    }
+    storeProcesses(snapshot, m_processes + slot * kJournalProcesses);
+
+    // Slot first, header last, so the header never points at a tick the
+    // process had not finished. The checksum catches what msync may leave
+    // half on disk when the machine dies.
+    m_slotChecksum[slot] = checksum(slot, seq);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_slotSequence[slot] = seq + 1;
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->sequence = seq + 1;
+
+    {
+        std::lock_guard<std::mutex> lock(m_flushMutex);
+        m_flushPending = true;
+    }
+    m_flushWake.notify_one();
+}
+
+void MetricJournal::flushLoop() {
+    std::unique_lock<std::mutex> lock(m_flushMutex);
+    for (;;) {
+        m_flushWake.wait(lock, [this] { return m_flushPending || m_stopping; });
+        if (!m_flushPending) {
+            return;
+        }
+        m_flushPending = false;
+        lock.unlock();
+        // Only the pages dirtied since the last pass are written.
+        msync(m_map, m_mapSize, MS_SYNC);
+        lock.lock();
+    }
+}
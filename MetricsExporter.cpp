@@ -0,0 +1,575 @@
+#include "headers/MetricsExporter.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const char* const kPrefix = "guitaskmanager_";
+static const size_t kMaxClients = 64;
+static const size_t kMaxRequest = 8192;
+// A scraper that has not sent its request or taken its answer by then is
+// closed, so a stuck one cannot hold a slot for ever.
+static const std::chrono::seconds kClientTimeout(10);
+static const char* const kOpenMetricsType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+static const char* const kTextType = "text/plain; charset=utf-8";
+
+// --- Text format -----------------------------------------------------------
+
+static void appendFamily(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# TYPE ";
+    out += kPrefix;
+    out += name;
+    out += ' ';
+    out += type;
+    out += "\n# HELP ";
+    out += kPrefix;
+    out += name;
+    out += ' ';
+    out += help;
+    out += '\n';
+}
+
+static void appendValue(std::string& out, double value) {
+    if (std::isnan(value)) {
+        out += "NaN";
+    } else if (std::isinf(value)) {
+        out += value > 0 ? "+Inf" : "-Inf";
+    } else {
+        char buffer[32];
+        int len = std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+        out.append(buffer, static_cast<size_t>(len));
+    }
+}
+
+static void appendValue(std::string& out, uint64_t value) {
+    char buffer[24];
+    int len = std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+    out.append(buffer, static_cast<size_t>(len));
+}
+
+// suffix is "_total" for the samples of a counter family.
+template <typename T>
+static void appendSample(std::string& out, const char* name, const char* suffix,
+                         const std::string& labels, T value) {
+    out += kPrefix;
+    out += name;
+    out += suffix;
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    appendValue(out, value);
+    out += '\n';
+}
+
+static void appendLabel(std::string& labels, const char* key, const char* value, size_t size) {
+    if (!labels.empty()) {
+        labels += ',';
+    }
+    labels += key;
+    labels += "=\"";
+    for (size_t i = 0; i < size; ++i) {
+        char c = value[i];
+        if (c == '\\' || c == '"') {
+            labels += '\\';
+            labels += c;
+        } else if (c == '\n') {
+            labels += "\\n";
+        } else {
+            labels += c;
+        }
+    }
+    labels += '"';
+}
+
+static void appendLabel(std::string& labels, const char* key, const char* value) {
+    appendLabel(labels, key, value, std::strlen(value));
+}
+
+static void appendLabel(std::string& labels, const char* key, const std::string& value) {
+    appendLabel(labels, key, value.data(), value.size());
+}
+
+static void appendLabel(std::string& labels, const char* key, uint64_t value) {
+    char buffer[24];
+    int len = std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+    appendLabel(labels, key, buffer, static_cast<size_t>(len));
+}
+
+// --- Series ------------------------------------------------------------------
+
+struct MemoryField {
+    const char* name;
+    const char* help;
+    long MemInfo::*field;       // kB
+};
+
+static const MemoryField kMemoryFields[] = {
+    {"memory_total_bytes", "Usable RAM.", &MemInfo::memTotal},
+    {"memory_available_bytes", "RAM available to new allocations without swapping.", &MemInfo::memAvailable},
+    {"memory_free_bytes", "RAM not used at all.", &MemInfo::memFree},
+    {"memory_buffers_bytes", "Block device buffers.", &MemInfo::buffers},
+    {"memory_cached_bytes", "Page cache.", &MemInfo::cached},
+    {"memory_shared_bytes", "Shared memory and tmpfs.", &MemInfo::shmem},
+    {"memory_dirty_bytes", "Page cache waiting to be written back.", &MemInfo::dirty},
+    {"memory_committed_bytes", "Memory promised to processes.", &MemInfo::committedAs},
+    {"swap_total_bytes", "Swap space.", &MemInfo::swapTotal},
+    {"swap_free_bytes", "Unused swap space.", &MemInfo::swapFree},
+};
+
+struct DiskField {
+    const char* name;           // counter family, without _total
+    const char* help;
+    uint64_t DiskCounters::*field;
+    double scale;
+};
+
+static const DiskField kDiskFields[] = {
+    {"disk_reads_completed", "Reads completed.", &DiskCounters::readsCompleted, 1.0},
+    {"disk_writes_completed", "Writes completed.", &DiskCounters::writesCompleted, 1.0},
+    {"disk_read_bytes", "Bytes read.", &DiskCounters::sectorsRead, 512.0},
+    {"disk_written_bytes", "Bytes written.", &DiskCounters::sectorsWritten, 512.0},
+    {"disk_io_time_seconds", "Time spent with I/O in flight.", &DiskCounters::msDoingIo, 0.001},
+};
+
+struct InterfaceField {
+    const char* name;           // counter family, without _total
+    const char* help;
+    uint64_t InterfaceCounters::*field;
+};
+
+static const InterfaceField kInterfaceFields[] = {
+    {"network_receive_bytes", "Bytes received.", &InterfaceCounters::rxBytes},
+    {"network_transmit_bytes", "Bytes sent.", &InterfaceCounters::txBytes},
+    {"network_receive_packets", "Packets received.", &InterfaceCounters::rxPackets},
+    {"network_transmit_packets", "Packets sent.", &InterfaceCounters::txPackets},
+    {"network_receive_errors", "Receive errors.", &InterfaceCounters::rxErrors},
+    {"network_transmit_errors", "Transmit errors.", &InterfaceCounters::txErrors},
+    {"network_receive_drops", "Received packets dropped.", &InterfaceCounters::rxDropped},
+    {"network_transmit_drops", "Packets dropped before sending.", &InterfaceCounters::txDropped},
+};
+
+struct GpuField {
+    const char* name;
+    const char* help;
+    GpuMetric metric;
+    double (*value)(const GpuSample&);
+};
+
+static const GpuField kGpuFields[] = {
+    {"gpu_busy_ratio", "Share of time the GPU was busy.", GpuUsage,
+     [](const GpuSample& gpu) { return gpu.busyPercent / 100.0; }},
+    {"gpu_memory_total_bytes", "Video memory.", GpuVramTotal,
+     [](const GpuSample& gpu) { return static_cast<double>(gpu.vramTotalBytes); }},
+    {"gpu_memory_used_bytes", "Video memory in use.", GpuVramUsed,
+     [](const GpuSample& gpu) { return static_cast<double>(gpu.vramUsedBytes); }},
+    {"gpu_temperature_celsius", "GPU temperature.", GpuTemperature,
+     [](const GpuSample& gpu) { return gpu.temperatureC; }},
+    {"gpu_fan_rpm", "GPU fan speed.", GpuFan,
+     [](const GpuSample& gpu) { return gpu.fanRpm; }},
+    {"gpu_power_watts", "GPU power draw.", GpuPower,
+     [](const GpuSample& gpu) { return gpu.powerWatts; }},
+    {"gpu_clock_hertz", "GPU core clock.", GpuClock,
+     [](const GpuSample& gpu) { return gpu.clockMhz * 1e6; }},
+};
+
+MetricsExporter::MetricsExporter(size_t topProcesses)
+    : m_topProcesses(topProcesses) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    close();
+}
+
+void MetricsExporter::render(const StatsSnapshot& snapshot,
+                             const std::vector<InterfaceCounters>& interfaces,
+                             const std::vector<GpuSample>& gpus,
+                             std::string& out) {
+    static const std::string kNoLabels;
+    // One label set per disk, interface, GPU or process, built once and
+    // then used by each of its families.
+    size_t entities = std::max({size_t(1), snapshot.disks.size(), interfaces.size(), gpus.size()});
+    if (m_labels.size() < entities) {
+        m_labels.resize(entities);
+    }
+    std::string& labels = m_labels.front();
+
+    appendFamily(out, "sample_timestamp_seconds", "gauge", "When the sample was taken.");
+    appendSample(out, "sample_timestamp_seconds", "", kNoLabels, snapshot.timestamp);
+
+    appendFamily(out, "cpu_usage_ratio", "gauge", "Share of all CPU time that was busy.");
+    appendSample(out, "cpu_usage_ratio", "", kNoLabels, snapshot.cpuUsagePercent / 100.0);
+    if (!snapshot.perCpuUsagePercent.empty()) {
+        appendFamily(out, "cpu_core_usage_ratio", "gauge", "Share of each logical processor's time that was busy.");
+        for (size_t cpu = 0; cpu < snapshot.perCpuUsagePercent.size(); ++cpu) {
+            labels.clear();
+            appendLabel(labels, "cpu", cpu);
+            appendSample(out, "cpu_core_usage_ratio", "", labels, snapshot.perCpuUsagePercent[cpu] / 100.0);
+        }
+    }
+    if (!snapshot.cpuFreq.perCpuMhz.empty()) {
+        appendFamily(out, "cpu_frequency_hertz", "gauge", "Current clock of each logical processor.");
+        for (size_t cpu = 0; cpu < snapshot.cpuFreq.perCpuMhz.size(); ++cpu) {
+            labels.clear();
+            appendLabel(labels, "cpu", cpu);
+            appendSample(out, "cpu_frequency_hertz", "", labels, snapshot.cpuFreq.perCpuMhz[cpu] * 1e6);
+        }
+    }
+
+    for (const MemoryField& field : kMemoryFields) {
+        appendFamily(out, field.name, "gauge", field.help);
+        appendSample(out, field.name, "", kNoLabels,
+                     static_cast<uint64_t>(snapshot.memInfo.*field.field) * 1024);
+    }
+
+    for (size_t i = 0; i < snapshot.disks.size(); ++i) {
+        m_labels[i].clear();
+        appendLabel(m_labels[i], "device", snapshot.disks[i].deviceName);
+        appendLabel(m_labels[i], "mountpoint", snapshot.disks[i].mountPath);
+    }
+    if (!snapshot.disks.empty()) {
+        appendFamily(out, "disk_active_ratio", "gauge", "Share of the last interval the disk was busy.");
+        for (size_t i = 0; i < snapshot.disks.size(); ++i) {
+            appendSample(out, "disk_active_ratio", "", m_labels[i], snapshot.disks[i].activePercent / 100.0);
+        }
+        for (const DiskField& field : kDiskFields) {
+            appendFamily(out, field.name, "counter", field.help);
+            for (size_t i = 0; i < snapshot.disks.size(); ++i) {
+                double value = static_cast<double>(snapshot.disks[i].counters.*field.field) * field.scale;
+                appendSample(out, field.name, "_total", m_labels[i], value);
+            }
+        }
+        if (snapshot.metrics & MetricFilesystems) {
+            appendFamily(out, "filesystem_size_bytes", "gauge", "Size of the mounted filesystem.");
+            for (size_t i = 0; i < snapshot.disks.size(); ++i) {
+                appendSample(out, "filesystem_size_bytes", "", m_labels[i],
+                             static_cast<uint64_t>(snapshot.disks[i].fsInfo.total));
+            }
+            appendFamily(out, "filesystem_free_bytes", "gauge", "Free space on the mounted filesystem.");
+            for (size_t i = 0; i < snapshot.disks.size(); ++i) {
+                appendSample(out, "filesystem_free_bytes", "", m_labels[i],
+                             static_cast<uint64_t>(snapshot.disks[i].fsInfo.free));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < interfaces.size(); ++i) {
+        m_labels[i].clear();
+        appendLabel(m_labels[i], "interface", interfaces[i].name);
+    }
+    if (!interfaces.empty()) {
+        for (const InterfaceField& field : kInterfaceFields) {
+            appendFamily(out, field.name, "counter", field.help);
+            for (size_t i = 0; i < interfaces.size(); ++i) {
+                appendSample(out, field.name, "_total", m_labels[i], interfaces[i].*field.field);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < gpus.size(); ++i) {
+        m_labels[i].clear();
+        appendLabel(m_labels[i], "card", gpus[i].card);
+        appendLabel(m_labels[i], "name", gpus[i].deviceName);
+    }
+    for (const GpuField& field : kGpuFields) {
+        bool any = false;
+        for (size_t i = 0; i < gpus.size(); ++i) {
+            if (!gpus[i].has(field.metric)) continue;
+            if (!any) {
+                appendFamily(out, field.name, "gauge", field.help);
+                any = true;
+            }
+            appendSample(out, field.name, "", m_labels[i], field.value(gpus[i]));
+        }
+    }
+
+    if (snapshot.metrics & (MetricProcesses | MetricCpuDetails)) {
+        appendFamily(out, "processes", "gauge", "Processes running.");
+        appendSample(out, "processes", "", kNoLabels, static_cast<uint64_t>(snapshot.processCount));
+        appendFamily(out, "threads", "gauge", "Threads of all processes.");
+        appendSample(out, "threads", "", kNoLabels, static_cast<uint64_t>(snapshot.totalThreads));
+    }
+
+    if (snapshot.metrics & MetricProcesses) {
+        const std::vector<ProcessRow>& rows = snapshot.processes;
+
+        // The top N by CPU and the top N by memory, in the snapshot's order.
+        size_t top = std::min(m_topProcesses, rows.size());
+        m_order.resize(rows.size());
+        m_topRows.clear();
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t i = 0; i < rows.size(); ++i) m_order[i] = i;
+            std::partial_sort(m_order.begin(), m_order.begin() + static_cast<std::ptrdiff_t>(top), m_order.end(),
+                              [&rows, pass](size_t a, size_t b) {
+                                  return pass == 0 ? rows[a].cpuPercent > rows[b].cpuPercent
+                                                   : rows[a].memoryKb > rows[b].memoryKb;
+                              });
+            m_topRows.insert(m_topRows.end(), m_order.begin(), m_order.begin() + static_cast<std::ptrdiff_t>(top));
+        }
+        std::sort(m_topRows.begin(), m_topRows.end());
+        m_topRows.erase(std::unique(m_topRows.begin(), m_topRows.end()), m_topRows.end());
+
+        if (m_labels.size() < m_topRows.size()) {
+            m_labels.resize(m_topRows.size());
+        }
+        bool anyIo = false;
+        for (size_t i = 0; i < m_topRows.size(); ++i) {
+            const ProcessRow& row = rows[m_topRows[i]];
+            m_labels[i].clear();
+            appendLabel(m_labels[i], "pid", static_cast<uint64_t>(row.pid));
+            appendLabel(m_labels[i], "name", row.name);
+            appendLabel(m_labels[i], "user", row.owner ? row.owner->c_str() : "");
+            anyIo = anyIo || row.hasIo;
+        }
+        appendFamily(out, "process_cpu_ratio", "gauge", "Share of all CPU time the process used.");
+        for (size_t i = 0; i < m_topRows.size(); ++i) {
+            appendSample(out, "process_cpu_ratio", "", m_labels[i], rows[m_topRows[i]].cpuPercent / 100.0);
+        }
+        appendFamily(out, "process_resident_bytes", "gauge", "Resident memory of the process.");
+        for (size_t i = 0; i < m_topRows.size(); ++i) {
+            appendSample(out, "process_resident_bytes", "", m_labels[i],
+                         static_cast<uint64_t>(rows[m_topRows[i]].memoryKb) * 1024);
+        }
+        appendFamily(out, "process_threads", "gauge", "Threads of the process.");
+        for (size_t i = 0; i < m_topRows.size(); ++i) {
+            appendSample(out, "process_threads", "", m_labels[i], static_cast<uint64_t>(rows[m_topRows[i]].threads));
+        }
+        if (anyIo) {
+            appendFamily(out, "process_read_bytes_per_second", "gauge", "Storage read rate of the process.");
+            for (size_t i = 0; i < m_topRows.size(); ++i) {
+                appendSample(out, "process_read_bytes_per_second", "", m_labels[i], rows[m_topRows[i]].readBytesPerSec);
+            }
+            appendFamily(out, "process_written_bytes_per_second", "gauge", "Storage write rate of the process.");
+            for (size_t i = 0; i < m_topRows.size(); ++i) {
+                appendSample(out, "process_written_bytes_per_second", "", m_labels[i], rows[m_topRows[i]].writeBytesPerSec);
+            }
+        }
+    }
+
+    out += "# EOF\n";
+}
+
+void MetricsExporter::publish(const StatsSnapshot& snapshot,
+                              const std::vector<InterfaceCounters>& interfaces,
+                              const std::vector<GpuSample>& gpus) {
+    m_body.clear();
+    render(snapshot, interfaces, gpus, m_body);
+
+    std::atomic_store(&m_response, makeResponse("200 OK", kOpenMetricsType, m_body));
+}
+
+std::shared_ptr<const MetricsExporter::Response> MetricsExporter::makeResponse(
+    const char* status, const char* contentType, const std::string& body) {
+    char header[256];
+    int headerSize = std::snprintf(header, sizeof(header),
+                                   "HTTP/1.1 %s\r\n"
+                                   "Content-Type: %s\r\n"
+                                   "Content-Length: %zu\r\n"
+                                   "Connection: close\r\n\r\n",
+                                   status, contentType, body.size());
+    std::shared_ptr<Response> response = std::make_shared<Response>();
+    response->bytes.reserve(static_cast<size_t>(headerSize) + body.size());
+    response->bytes.append(header, static_cast<size_t>(headerSize));
+    response->bytes += body;
+    response->headerSize = static_cast<size_t>(headerSize);
+    return response;
+}
+
+// --- HTTP --------------------------------------------------------------------
+
+struct MetricsExporter::Client {
+    int fd = -1;
+    std::string request;
+    std::shared_ptr<const Response> response;   // null while the request is read
+    size_t size = 0;                            // bytes of response to send
+    size_t sent = 0;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+bool MetricsExporter::listen(const std::string& address, uint16_t port) {
+    close();
+    m_error.clear();
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV | AI_PASSIVE;
+    addrinfo* found = nullptr;
+    std::string service = std::to_string(port);
+    int status = getaddrinfo(address.c_str(), service.c_str(), &hints, &found);
+    if (status != 0) {
+        m_error = "bad metrics address " + address + ": " + gai_strerror(status);
+        return false;
+    }
+
+    m_listenFd = socket(found->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    bool bound = m_listenFd >= 0
+        && setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == 0
+        && bind(m_listenFd, found->ai_addr, found->ai_addrlen) == 0
+        && ::listen(m_listenFd, 16) == 0;
+    freeaddrinfo(found);
+
+    sockaddr_storage local = {};
+    socklen_t localSize = sizeof(local);
+    if (!bound
+        || getsockname(m_listenFd, reinterpret_cast<sockaddr*>(&local), &localSize) != 0
+        || pipe2(m_wakeFds, O_CLOEXEC | O_NONBLOCK) != 0) {
+        m_error = "cannot listen on " + address + ":" + service + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    m_port = ntohs(local.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6*>(&local)->sin6_port
+                                               : reinterpret_cast<sockaddr_in*>(&local)->sin_port);
+
+    m_thread = std::thread(&MetricsExporter::run, this);
+    return true;
+}
+
+void MetricsExporter::close() {
+    if (m_thread.joinable()) {
+        char wake = 1;
+        ssize_t ignored = write(m_wakeFds[1], &wake, 1);
+        (void)ignored;
+        m_thread.join();
+    }
+    for (int* fd : {&m_listenFd, &m_wakeFds[0], &m_wakeFds[1]}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+    m_port = 0;
+}
+
+void MetricsExporter::run() {
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+    for (;;) {
+        fds.clear();
+        fds.push_back({m_wakeFds[0], POLLIN, 0});
+        fds.push_back({m_listenFd, static_cast<short>(clients.size() < kMaxClients ? POLLIN : 0), 0});
+        for (const Client& client : clients) {
+            fds.push_back({client.fd, static_cast<short>(client.response ? POLLOUT : POLLIN), 0});
+        }
+        // Wakes at least once a second to expire clients.
+        if (::poll(fds.data(), fds.size(), 1000) < 0 && errno != EINTR) {
+            break;
+        }
+        if (fds[0].revents) {
+            break;
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        // Back to front, so closing a client does not shift the ones not yet
+        // looked at. The descriptors line up with clients shifted by two.
+        for (size_t i = clients.size(); i-- > 0;) {
+            Client& client = clients[i];
+            short revents = fds[i + 2].revents;
+            bool open = now < client.deadline;
+            if (open && revents) {
+                open = client.response ? send(client) : receive(client);
+            }
+            if (!open) {
+                ::close(client.fd);
+                clients.erase(clients.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            while (clients.size() < kMaxClients) {
+                int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) {
+                    break;
+                }
+                clients.emplace_back();
+                clients.back().fd = fd;
+                clients.back().deadline = now + kClientTimeout;
+            }
+        }
+    }
+
+    for (const Client& client : clients) {
+        ::close(client.fd);
+    }
+}
+
+bool MetricsExporter::receive(Client& client) {
+    static const std::shared_ptr<const Response> kNotYet =
+        makeResponse("503 Service Unavailable", kTextType, "No sample has been taken yet.\n");
+    static const std::shared_ptr<const Response> kIndex =
+        makeResponse("200 OK", kTextType, "GUITaskManager metrics are at /metrics.\n");
+    static const std::shared_ptr<const Response> kNotFound =
+        makeResponse("404 Not Found", kTextType, "Not found; try /metrics.\n");
+    static const std::shared_ptr<const Response> kBadMethod =
+        makeResponse("405 Method Not Allowed", kTextType, "Only GET and HEAD are served.\n");
+    static const std::shared_ptr<const Response> kBadRequest =
+        makeResponse("400 Bad Request", kTextType, "Bad request.\n");
+
+    char buffer[1024];
+    for (;;) {
+        ssize_t got = recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (got == 0) {
+            return false;
+        }
+        if (got < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) break;
+            return false;
+        }
+        client.request.append(buffer, static_cast<size_t>(got));
+    }
+
+    // Only the request line matters, but the headers are waited for so the
+    // scraper is not answered halfway through sending them.
+    const std::string& request = client.request;
+    bool complete = request.find("\r\n\r\n") != std::string::npos || request.find("\n\n") != std::string::npos;
+    if (!complete && request.size() <= kMaxRequest) {
+        return true;
+    }
+
+    bool head = false;
+    size_t methodEnd = request.find(' ');
+    size_t targetEnd = methodEnd == std::string::npos ? methodEnd : request.find(' ', methodEnd + 1);
+    if (!complete || targetEnd == std::string::npos) {
+        client.response = kBadRequest;
+    } else {
+        head = request.compare(0, methodEnd, "HEAD") == 0;
+        std::string target = request.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+        target.resize(std::min(target.size(), target.find('?')));
+        if (!head && request.compare(0, methodEnd, "GET") != 0) {
+            client.response = kBadMethod;
+        } else if (target == "/metrics") {
+            client.response = std::atomic_load(&m_response);
+            if (!client.response) client.response = kNotYet;
+        } else if (target == "/") {
+            client.response = kIndex;
+        } else {
+            client.response = kNotFound;
+        }
+    }
+    client.size = head ? client.response->headerSize : client.response->bytes.size();
+    return send(client);
+}
+
+bool MetricsExporter::send(Client& client) {
+    while (client.sent < client.size) {
+        ssize_t sent = ::send(client.fd, client.response->bytes.data() + client.sent,
+                              client.size - client.sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        client.sent += static_cast<size_t>(sent);
+    }
+    // Every answer says Connection: close.
+    return false;
+}
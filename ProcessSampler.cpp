@@ -0,0 +1,437 @@
+#include "headers/ProcessSampler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <thread>
+
+static const char* const kProcFileNames[] = {"stat", "statm", "status", "io"};
+
+// Descriptors left for the rest of the application (Qt, popen, sysfs reads).
+static const size_t kMinFdReserve = 256;
+// Soft RLIMIT_NOFILE raiseFdLimit() asks for. The usual default of 1024
+// leaves room to cache only a couple of hundred processes.
+static const rlim_t kWantedFdLimit = 65536;
+// Passes the cache stops growing for after open() ran out of descriptors.
+static const unsigned kFdBackoffPasses = 30;
+
+// Descriptors the cache may hold under the current soft limit.
+static size_t fdBudgetFromLimit() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+        return 0;
+    }
+    size_t soft = limit.rlim_cur == RLIM_INFINITY ? 65536 : static_cast<size_t>(limit.rlim_cur);
+    size_t reserve = std::max(kMinFdReserve, soft / 4);
+    return soft > reserve ? soft - reserve : 0;
+}
+
+static const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+static const char* skipField(const char* p, const char* end) {
+    p = skipSpaces(p, end);
+    while (p < end && *p != ' ' && *p != '\n') ++p;
+    return p;
+}
+
+static const char* parseNumber(const char* p, const char* end, long long& value) {
+    p = skipSpaces(p, end);
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        ++p;
+    }
+    long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p - '0');
+        ++p;
+    }
+    value = negative ? -v : v;
+    return p;
+}
+
+// Finds "key" at the start of a line and returns a pointer just past it.
+static const char* findKey(const char* buf, const char* end, const char* key) {
+    size_t keyLen = std::strlen(key);
+    const char* p = buf;
+    while (p < end) {
+        if (static_cast<size_t>(end - p) >= keyLen && std::memcmp(p, key, keyLen) == 0) {
+            return p + keyLen;
+        }
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!nl) break;
+        p = nl + 1;
+    }
+    return nullptr;
+}
+
+static bool parseStat(const char* buf, ssize_t len, ProcessSample& out) {
+    const char* end = buf + len;
+    const char* open = static_cast<const char*>(std::memchr(buf, '(', len));
+    const char* close = nullptr;
+    // comm may itself contain ')', so the last one terminates it.
+    for (const char* p = end - 1; p > buf; --p) {
+        if (*p == ')') {
+            close = p;
+            break;
+        }
+    }
+    if (!open || !close || close < open) {
+        return false;
+    }
+
+    size_t nameLen = static_cast<size_t>(close - open - 1);
+    if (nameLen >= sizeof(out.name)) nameLen = sizeof(out.name) - 1;
+    std::memcpy(out.name, open + 1, nameLen);
+    out.name[nameLen] = '\0';
+
+    const char* p = skipSpaces(close + 1, end);
+    if (p >= end) {
+        return false;
+    }
+    out.state = *p++;
+
+    long long value = 0;
+    p = parseNumber(p, end, value);                 // 4  ppid
+    out.ppid = static_cast<int>(value);
+    for (int i = 5; i <= 13; ++i) p = skipField(p, end);
+
+    long long utime = 0, stime = 0, cutime = 0, cstime = 0;
+    p = parseNumber(p, end, utime);                 // 14 utime
+    p = parseNumber(p, end, stime);                 // 15 stime
+    p = parseNumber(p, end, cutime);                // 16 cutime
+    p = parseNumber(p, end, cstime);                // 17 cstime
+    out.activeJiffies = static_cast<long>(utime + stime + cutime + cstime);
+
+    p = skipField(p, end);                          // 18 priority
+    p = skipField(p, end);                          // 19 nice
+    p = parseNumber(p, end, value);                 // 20 num_threads
+    out.threads = static_cast<long>(value);
+    p = skipField(p, end);                          // 21 itrealvalue
+    p = parseNumber(p, end, value);                 // 22 starttime
+    out.startTime = static_cast<unsigned long long>(value);
+    for (int i = 23; i <= 38; ++i) p = skipField(p, end);
+    p = skipSpaces(p, end);
+    out.lastCpu = -1;
+    if (p < end && *p >= '0' && *p <= '9') {
+        parseNumber(p, end, value);                 // 39 processor
+        out.lastCpu = static_cast<int>(value);
+    }
+    return true;
+}
+
+// Shards per worker; more shards than workers is what gives stealing room.
+static const size_t kShardsPerWorker = 8;
+
+ProcessSampler::ProcessSampler(const SystemRoots& roots, unsigned workers)
+    : m_procRoot(roots.proc)
+    , m_uidCache(roots.etc + "/passwd") {
+    long pageSize = sysconf(_SC_PAGESIZE);
+    m_pageKb = pageSize > 0 ? pageSize / 1024 : 4;
+
+    m_fdBudget = fdBudgetFromLimit();
+
+    setWorkerCount(workers);
+}
+
+ProcessSampler::~ProcessSampler() {
+    clearCache();
+}
+
+unsigned ProcessSampler::defaultWorkerCount() {
+    unsigned cores = std::thread::hardware_concurrency();
+    return std::min(4u, std::max(1u, cores / 8));
+}
+
+void ProcessSampler::raiseFdLimit() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY
+        && limit.rlim_cur < kWantedFdLimit && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max == RLIM_INFINITY ? kWantedFdLimit
+                                                         : std::min(limit.rlim_max, kWantedFdLimit);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+void ProcessSampler::setWorkerCount(unsigned workers) {
+    if (workers == 0) workers = 1;
+
+    clearCache();
+    m_pool.reset(workers > 1 ? new WorkStealingPool(workers) : nullptr);
+    m_shards = std::vector<Shard>(workers > 1 ? workers * kShardsPerWorker : 1);
+}
+
+void ProcessSampler::clearCache() {
+    for (Shard& shard : m_shards) {
+        for (auto& [pid, cached] : shard.cache) {
+            closeCached(cached);
+        }
+        shard.cache.clear();
+    }
+}
+
+void ProcessSampler::closeCached(CachedProcess& cached) {
+    for (int& fd : cached.fds) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+            --m_openFds;
+        }
+    }
+}
+
+void ProcessSampler::evict(Shard& shard, int pid) {
+    auto it = shard.cache.find(pid);
+    if (it != shard.cache.end()) {
+        closeCached(it->second);
+        shard.cache.erase(it);
+    }
+}
+
+void ProcessSampler::evictStale(Shard& shard) {
+    for (auto it = shard.cache.begin(); it != shard.cache.end();) {
+        if (it->second.generation != m_generation) {
+            closeCached(it->second);
+            it = shard.cache.erase(it);
+        } else {
+            // Over budget after EMFILE: hand descriptors back so the next
+            // pass can still open the files it has no descriptor for.
+            if (m_openFds.load() > m_fdBudget.load()) {
+                closeCached(it->second);
+            }
+            ++it;
+        }
+    }
+}
+
+ssize_t ProcessSampler::readProcFile(int pid, ProcFile file, CachedProcess* cached, char* buf, size_t cap) {
+    if (cached && cached->fds[file] >= 0) {
+        ssize_t len = pread(cached->fds[file], buf, cap - 1, 0);
+        if (len < 0) {
+            return -1;
+        }
+        buf[len] = '\0';
+        return len;
+    }
+
+    char path[512];
+    std::snprintf(path, sizeof(path), "%s/%d/%s", m_procRoot.c_str(), pid, kProcFileNames[file]);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == EMFILE || errno == ENFILE) {
+            // Someone else is using descriptors too; shrink the cache for a
+            // while. sample() lifts the clamp again.
+            m_fdBudget = m_openFds.load() / 2;
+            m_fdBackoffPasses = kFdBackoffPasses;
+        }
+        return -1;
+    }
+
+    ssize_t len = pread(fd, buf, cap - 1, 0);
+    // Reserve the slot before keeping the descriptor; checking the count
+    // first would let concurrent workers all pass the check at once.
+    bool keep = false;
+    if (cached && len >= 0) {
+        keep = m_openFds.fetch_add(1) < m_fdBudget.load();
+        if (!keep) {
+            m_openFds.fetch_sub(1);
+        }
+    }
+    if (keep) {
+        cached->fds[file] = fd;
+    } else {
+        close(fd);
+    }
+    if (len < 0) {
+        return -1;
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+bool ProcessSampler::sampleProcess(int pid, unsigned fields, ProcessSample& out) {
+    if (!sampleInto(shardFor(pid), pid, fields, out)) {
+        return false;
+    }
+    if (out.hasUid) {
+        out.owner = m_uidCache.lookup(out.uid);
+    }
+    return true;
+}
+
+bool ProcessSampler::sampleInto(Shard& shard, int pid, unsigned fields, ProcessSample& out) {
+    char buf[4096];
+
+    out = ProcessSample();
+    out.pid = pid;
+
+    auto it = shard.cache.find(pid);
+    if (it == shard.cache.end()) {
+        it = shard.cache.emplace(pid, CachedProcess()).first;
+    }
+    CachedProcess* cached = &it->second;
+
+    ssize_t len = readProcFile(pid, FileStat, cached, buf, sizeof(buf));
+    if (len <= 0 && cached->fds[FileStat] >= 0) {
+        // ESRCH on a cached descriptor: the task it was opened for is gone,
+        // but the PID may already belong to a new process.
+        closeCached(*cached);
+        len = readProcFile(pid, FileStat, cached, buf, sizeof(buf));
+    }
+    if (len <= 0 || !parseStat(buf, len, out)) {
+        evict(shard, pid);
+        return false;
+    }
+
+    if (cached->startTime != 0 && cached->startTime != out.startTime) {
+        // Recycled PID: nothing opened for the previous owner can be reused.
+        closeCached(*cached);
+    }
+    cached->startTime = out.startTime;
+    cached->generation = m_generation;
+
+    len = readProcFile(pid, FileStatm, cached, buf, sizeof(buf));
+    if (len > 0) {
+        long long size = 0, resident = 0;
+        const char* p = parseNumber(buf, buf + len, size);
+        parseNumber(p, buf + len, resident);
+        out.memoryKb = static_cast<long>(resident) * m_pageKb;
+    }
+
+    if (fields & SampleOwner) {
+        len = readProcFile(pid, FileStatus, cached, buf, sizeof(buf));
+        if (len > 0) {
+            const char* p = findKey(buf, buf + len, "Uid:");
+            if (p) {
+                long long uid = 0;
+                parseNumber(p, buf + len, uid);
+                out.uid = static_cast<uid_t>(uid);
+                out.hasUid = true;
+            }
+        }
+    }
+
+    if (fields & SampleIo) {
+        len = readProcFile(pid, FileIo, cached, buf, sizeof(buf));
+        if (len > 0) {
+            long long value = 0;
+            const char* p = findKey(buf, buf + len, "read_bytes:");
+            if (p) {
+                parseNumber(p, buf + len, value);
+                out.io.readBytes = static_cast<long>(value);
+            }
+            p = findKey(buf, buf + len, "write_bytes:");
+            if (p) {
+                parseNumber(p, buf + len, value);
+                out.io.writeBytes = static_cast<long>(value);
+            }
+            out.hasIo = true;
+        }
+    }
+
+    return true;
+}
+
+void ProcessSampler::sampleShard(Shard& shard, unsigned fields) {
+    ProcessSample record;
+    for (int pid : shard.pids) {
+        // The process may exit between readdir and the reads; just skip it.
+        if (sampleInto(shard, pid, fields, record)) {
+            shard.out.push_back(record);
+        }
+    }
+
+    // PIDs that vanished from /proc since the last pass.
+    evictStale(shard);
+}
+
+void ProcessSampler::sample(unsigned fields, std::vector<ProcessSample>& out) {
+    out.clear();
+    ++m_generation;
+
+    // Follows the soft limit, so a clamp after EMFILE or a limit raised
+    // with prlimit is picked up without a restart.
+    if (m_fdBackoffPasses.load() > 0) {
+        --m_fdBackoffPasses;
+    } else {
+        m_fdBudget = fdBudgetFromLimit();
+    }
+
+    for (Shard& shard : m_shards) {
+        shard.pids.clear();
+        shard.out.clear();
+    }
+
+    DIR* dir = opendir(m_procRoot.c_str());
+    if (!dir) {
+        return;
+    }
+
+    while (struct dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (!std::isdigit(static_cast<unsigned char>(name[0]))) {
+            continue;
+        }
+        int pid = 0;
+        bool numeric = true;
+        for (const char* c = name; *c; ++c) {
+            if (*c < '0' || *c > '9') {
+                numeric = false;
+                break;
+            }
+            pid = pid * 10 + (*c - '0');
+        }
+        if (numeric) {
+            shardFor(pid).pids.push_back(pid);
+        }
+    }
+
+    closedir(dir);
+
+    if (m_pool) {
+        m_pool->run(m_shards.size(), [&](size_t index, unsigned) {
+            sampleShard(m_shards[index], fields);
+        });
+    } else {
+        for (Shard& shard : m_shards) {
+            sampleShard(shard, fields);
+        }
+    }
+
+    // Merge the per-shard slices. Owner names are resolved here, on the
+    // calling thread, because UidCache is not thread-safe.
+    for (Shard& shard : m_shards) {
+        for (ProcessSample& record : shard.out) {
+            if (record.hasUid) {
+                record.owner = m_uidCache.lookup(record.uid);
+            }
+            out.push_back(std::move(record));
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const ProcessSample& a, const ProcessSample& b) {
+        return a.pid < b.pid;
+    });
+}
+
+const char* ProcessSampler::stateName(char state) {
+    switch (state) {
+        case 'R': return "R (running)";
+        case 'S': return "S (sleeping)";
+        case 'D': return "D (disk sleep)";
+        case 'T': return "T (stopped)";
+        case 't': return "t (tracing stop)";
+        case 'X': return "X (dead)";
+        case 'Z': return "Z (zombie)";
+        case 'P': return "P (parked)";
+        case 'I': return "I (idle)";
+        default:  return "?";
+    }
+}
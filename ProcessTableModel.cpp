@@ -0,0 +1,207 @@
+#include "headers/ProcessTableModel.h"
+#include "headers/ProcessSampler.h"
+#include <QHash>
+#include <algorithm>
+#include <cstring>
+
+ProcessTableModel::ProcessTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int ProcessTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int ProcessTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+int ProcessTableModel::pidAt(int row) const
+{
+    if (row < 0 || row >= static_cast<int>(m_rows.size())) {
+        return -1;
+    }
+    return m_rows[row].pid;
+}
+
+QVariant ProcessTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size())) {
+        return QVariant();
+    }
+    const Row &row = m_rows[index.row()];
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+            case ColName: return row.name;
+            case ColPid: return row.pid;
+            case ColCpu: return QString::number(row.cpuPercent, 'f', 1);
+            case ColMemory: return static_cast<qlonglong>(row.memoryKb);
+            case ColOwner: return row.owner;
+            case ColStatus: return QString::fromLatin1(ProcessSampler::stateName(row.state));
+            case ColNode: return row.numaNode >= 0 ? QVariant(row.numaNode) : QVariant(QString("N/A"));
+        }
+    } else if (role == SortRole) {
+        switch (index.column()) {
+            case ColName: return row.name;
+            case ColPid: return row.pid;
+            case ColCpu: return row.cpuPercent;
+            case ColMemory: return static_cast<qlonglong>(row.memoryKb);
+            case ColOwner: return row.owner;
+            case ColStatus: return QString(QChar(row.state));
+            case ColNode: return row.numaNode;
+        }
+    } else if (role == Qt::TextAlignmentRole) {
+        if (index.column() == ColPid || index.column() == ColCpu || index.column() == ColMemory
+            || index.column() == ColNode) {
+            return int(Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+    return QVariant();
+}
+
+QVariant ProcessTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+        case ColName: return QString("Name");
+        case ColPid: return QString("PID");
+        case ColCpu: return QString("CPU %");
+        case ColMemory: return QString("Memory (KB)");
+        case ColOwner: return QString("Owner");
+        case ColStatus: return QString("Status");
+        case ColNode: return QString("NUMA node");
+    }
+    return QVariant();
+}
+
+void ProcessTableModel::assign(Row &row, const ProcessRow &process, const QString &owner) const
+{
+    row.pid = process.pid;
+    std::memcpy(row.rawName, process.name, sizeof(row.rawName));
+    row.name = QString::fromUtf8(process.name);
+    row.owner = owner;
+    row.state = process.state;
+    row.cpuPercent = process.cpuPercent;
+    row.memoryKb = process.memoryKb;
+    row.numaNode = process.numaNode;
+}
+
+void ProcessTableModel::updateFromSnapshot(const StatsSnapshot &snapshot)
+{
+    const std::vector<ProcessRow> &processes = snapshot.processes;
+
+    // Owners are interned, so each distinct user is converted once per update.
+    QHash<const std::string*, QString> ownerNames;
+    auto ownerName = [&](const ProcessRow &process) {
+        if (!process.owner) {
+            return QString("N/A");
+        }
+        auto it = ownerNames.find(process.owner.get());
+        if (it == ownerNames.end()) {
+            it = ownerNames.insert(process.owner.get(), QString::fromStdString(*process.owner));
+        }
+        return it.value();
+    };
+
+    // Consecutive changed rows are reported as one dataChanged range.
+    int changedFirst = -1, changedLast = -1;
+    int columnFirst = ColumnCount, columnLast = -1;
+    auto flushChanged = [&]() {
+        if (changedFirst >= 0) {
+            emit dataChanged(index(changedFirst, columnFirst), index(changedLast, columnLast));
+        }
+        changedFirst = changedLast = -1;
+        columnFirst = ColumnCount;
+        columnLast = -1;
+    };
+
+    size_t i = 0, j = 0;
+    while (i < m_rows.size() || j < processes.size()) {
+        if (j == processes.size() || (i < m_rows.size() && m_rows[i].pid < processes[j].pid)) {
+            // Run of rows whose processes have exited.
+            flushChanged();
+            size_t end = i;
+            while (end < m_rows.size() && (j == processes.size() || m_rows[end].pid < processes[j].pid)) {
+                ++end;
+            }
+            beginRemoveRows(QModelIndex(), static_cast<int>(i), static_cast<int>(end) - 1);
+            m_rows.erase(m_rows.begin() + i, m_rows.begin() + end);
+            endRemoveRows();
+        } else if (i == m_rows.size() || m_rows[i].pid > processes[j].pid) {
+            // Run of new processes that sort before the current row.
+            flushChanged();
+            size_t end = j;
+            while (end < processes.size() && (i == m_rows.size() || processes[end].pid < m_rows[i].pid)) {
+                ++end;
+            }
+            size_t count = end - j;
+            beginInsertRows(QModelIndex(), static_cast<int>(i), static_cast<int>(i + count) - 1);
+            std::vector<Row> inserted(count);
+            for (size_t k = 0; k < count; ++k) {
+                assign(inserted[k], processes[j + k], ownerName(processes[j + k]));
+            }
+            m_rows.insert(m_rows.begin() + i, inserted.begin(), inserted.end());
+            endInsertRows();
+            i += count;
+            j = end;
+        } else {
+            Row &row = m_rows[i];
+            const ProcessRow &process = processes[j];
+            int first = ColumnCount, last = -1;
+            auto mark = [&](int column) {
+                first = std::min(first, column);
+                last = std::max(last, column);
+            };
+
+            if (std::memcmp(row.rawName, process.name, sizeof(row.rawName)) != 0) {
+                std::memcpy(row.rawName, process.name, sizeof(row.rawName));
+                row.name = QString::fromUtf8(process.name);
+                mark(ColName);
+            }
+            if (row.cpuPercent != process.cpuPercent) {
+                row.cpuPercent = process.cpuPercent;
+                mark(ColCpu);
+            }
+            if (row.memoryKb != process.memoryKb) {
+                row.memoryKb = process.memoryKb;
+                mark(ColMemory);
+            }
+            if (process.owner) {
+                QString owner = ownerName(process);
+                if (row.owner != owner) {
+                    row.owner = owner;
+                    mark(ColOwner);
+                }
+            }
+            if (row.state != process.state) {
+                row.state = process.state;
+                mark(ColStatus);
+            }
+            if (row.numaNode != process.numaNode) {
+                row.numaNode = process.numaNode;
+                mark(ColNode);
+            }
+
+            if (last >= 0) {
+                if (changedLast != static_cast<int>(i) - 1) {
+                    flushChanged();
+                }
+                if (changedFirst < 0) changedFirst = static_cast<int>(i);
+                changedLast = static_cast<int>(i);
+                columnFirst = std::min(columnFirst, first);
+                columnLast = std::max(columnLast, last);
+            } else {
+                flushChanged();
+            }
+            ++i;
+            ++j;
+        }
+    }
+    flushChanged();
+}
@@ -0,0 +1,518 @@
+#include "headers/SnapshotRecording.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const char kRecordingMagic[8] = {'G', 'T', 'M', 'R', 'E', 'C', '1', '\0'};
+static const uint64_t kRecordingVersion = 2;
+// Larger than any real tick; anything bigger is a damaged length prefix.
+static const uint32_t kMaxRecordSize = 256u << 20;
+
+static long MemInfo::* const kMemInfoFields[] = {
+    &MemInfo::memTotal, &MemInfo::memFree, &MemInfo::memAvailable, &MemInfo::buffers,
+    &MemInfo::cached, &MemInfo::swapCached, &MemInfo::swapTotal, &MemInfo::swapFree,
+    &MemInfo::shmem, &MemInfo::sReclaimable, &MemInfo::dirty, &MemInfo::writeback,
+    &MemInfo::anonPages, &MemInfo::mapped, &MemInfo::hugePagesTotal, &MemInfo::hugePagesFree,
+    &MemInfo::hugePagesRsvd, &MemInfo::hugePagesSurp, &MemInfo::hugePageSizeKb,
+    &MemInfo::committedAs, &MemInfo::commitLimit,
+};
+
+static uint64_t DiskCounters::* const kDiskCounterFields[] = {
+    &DiskCounters::readsCompleted, &DiskCounters::readsMerged, &DiskCounters::sectorsRead,
+    &DiskCounters::msReading, &DiskCounters::writesCompleted, &DiskCounters::writesMerged,
+    &DiskCounters::sectorsWritten, &DiskCounters::msWriting, &DiskCounters::iosInProgress,
+    &DiskCounters::msDoingIo, &DiskCounters::weightedMsDoingIo, &DiskCounters::discardsCompleted,
+    &DiskCounters::discardsMerged, &DiskCounters::sectorsDiscarded, &DiskCounters::msDiscarding,
+    &DiskCounters::flushesCompleted, &DiskCounters::msFlushing,
+};
+
+enum ProcessRowFlags : unsigned {
+    RowHasIo = 1u << 0,
+};
+
+namespace {
+
+struct Encoder {
+    std::vector<uint8_t>& out;
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+    void signedVarint(int64_t value) {
+        varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+    void bytes(const void* data, size_t size) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), p, p + size);
+    }
+    void f64(double value) { bytes(&value, sizeof(value)); }
+    void f32(float value) { bytes(&value, sizeof(value)); }
+    void string(const char* data, size_t size) {
+        varint(size);
+        bytes(data, size);
+    }
+    void string(const std::string& value) { string(value.data(), value.size()); }
+    void doubles(const std::vector<double>& values) {
+        varint(values.size());
+        bytes(values.data(), values.size() * sizeof(double));
+    }
+};
+
+// Every read past the end yields zero and clears ok, so a damaged record is
+// caught once at the end instead of after each field.
+struct Decoder {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p == end) {
+                ok = false;
+                return 0;
+            }
+            uint8_t byte = *p++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        ok = false;
+        return 0;
+    }
+    int64_t signedVarint() {
+        uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+    bool bytes(void* data, size_t size) {
+        if (static_cast<size_t>(end - p) < size) {
+            ok = false;
+            p = end;
+            return false;
+        }
+        std::memcpy(data, p, size);
+        p += size;
+        return true;
+    }
+    double f64() {
+        double value = 0.0;
+        bytes(&value, sizeof(value));
+        return value;
+    }
+    float f32() {
+        float value = 0.0f;
+        bytes(&value, sizeof(value));
+        return value;
+    }
+    // A count that could not possibly fit in what is left is damage, not an
+    // allocation to attempt.
+    size_t count(size_t minElementSize) {
+        uint64_t n = varint();
+        if (n > static_cast<uint64_t>(end - p) / minElementSize) {
+            ok = false;
+            return 0;
+        }
+        return static_cast<size_t>(n);
+    }
+    void string(std::string& out) {
+        size_t size = count(1);
+        out.assign(reinterpret_cast<const char*>(p), size);
+        p += size;
+    }
+    size_t string(char* out, size_t capacity) {
+        size_t size = count(1);
+        size_t kept = std::min(size, capacity);
+        std::memcpy(out, p, kept);
+        p += size;
+        return kept;
+    }
+    void doubles(std::vector<double>& out) {
+        out.resize(count(sizeof(double)));
+        bytes(out.data(), out.size() * sizeof(double));
+    }
+};
+
+void putUint32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint32_t getUint32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    return value;
+}
+
+} // namespace
+
+SnapshotWriter::~SnapshotWriter() {
+    close();
+}
+
+bool SnapshotWriter::open(const std::string& path, const std::vector<std::string>& mountPaths) {
+    close();
+    m_error.clear();
+    m_owners.clear();
+
+    m_file = std::fopen(path.c_str(), "wbe");
+    if (!m_file) {
+        m_error = "cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    std::vector<uint8_t> header = encodeHeader(mountPaths);
+    if (std::fwrite(header.data(), 1, header.size(), m_file) != header.size()
+        || std::fflush(m_file) != 0) {
+        m_error = "cannot write " + path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    return true;
+}
+
+std::vector<uint8_t> SnapshotWriter::encodeHeader(const std::vector<std::string>& mountPaths) {
+    std::vector<uint8_t> header(sizeof(kRecordingMagic) + 4, 0);
+    std::memcpy(header.data(), kRecordingMagic, sizeof(kRecordingMagic));
+    Encoder enc{header};
+    enc.varint(kRecordingVersion);
+    enc.varint(mountPaths.size());
+    for (const std::string& mountPath : mountPaths) {
+        enc.string(mountPath);
+    }
+    putUint32(header.data() + sizeof(kRecordingMagic),
+              static_cast<uint32_t>(header.size() - sizeof(kRecordingMagic) - 4));
+    return header;
+}
+
+void SnapshotWriter::close() {
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+const std::vector<uint8_t>& SnapshotWriter::encode(const StatsSnapshot& snapshot) {
+    m_buffer.clear();
+    m_buffer.resize(4);     // length prefix, filled in below
+    Encoder enc{m_buffer};
+
+    enc.varint(snapshot.metrics);
+    enc.f64(snapshot.timestamp);
+    enc.f64(snapshot.intervalSec);
+    enc.f64(snapshot.cpuUsagePercent);
+    enc.doubles(snapshot.perCpuUsagePercent);
+    enc.doubles(snapshot.perSocketUsagePercent);
+    enc.doubles(snapshot.perNodeUsagePercent);
+    enc.doubles(snapshot.cpuFreq.perCpuMhz);
+    enc.f64(snapshot.cpuFreq.minMhz);
+    enc.f64(snapshot.cpuFreq.avgMhz);
+    enc.f64(snapshot.cpuFreq.maxMhz);
+    enc.f64(snapshot.cpuFreq.ratedMaxMhz);
+    enc.string(snapshot.uptime);
+
+    for (long MemInfo::* field : kMemInfoFields) {
+        enc.signedVarint(snapshot.memInfo.*field);
+    }
+    enc.f64(snapshot.memUsagePercent);
+
+    enc.f64(snapshot.diskActivePercent);
+    enc.varint(snapshot.disks.size());
+    for (const DiskSample& disk : snapshot.disks) {
+        enc.string(disk.mountPath);
+        enc.string(disk.deviceName);
+        enc.f64(disk.activePercent);
+        enc.f64(disk.readBytesPerSec);
+        enc.f64(disk.writeBytesPerSec);
+        enc.varint(disk.counters.major);
+        enc.varint(disk.counters.minor);
+        enc.string(disk.counters.name, strnlen(disk.counters.name, sizeof(disk.counters.name)));
+        for (uint64_t DiskCounters::* field : kDiskCounterFields) {
+            enc.varint(disk.counters.*field);
+        }
+        enc.signedVarint(disk.fsInfo.total);
+        enc.signedVarint(disk.fsInfo.free);
+    }
+
+    enc.f64(snapshot.netSendBitsPerSec);
+    enc.f64(snapshot.netRecvBitsPerSec);
+
+    // Owners first seen in this tick, then rows that refer to them by number.
+    m_newOwners.clear();
+    for (const ProcessRow& row : snapshot.processes) {
+        if (row.owner && m_owners.find(row.owner.get()) == m_owners.end()) {
+            m_owners.emplace(row.owner.get(), std::make_pair(row.owner, static_cast<uint32_t>(m_owners.size())));
+            m_newOwners.push_back(row.owner.get());
+        }
+    }
+    enc.varint(m_newOwners.size());
+    for (const std::string* owner : m_newOwners) {
+        enc.varint(m_owners[owner].second);
+        enc.string(*owner);
+    }
+
+    enc.varint(snapshot.processes.size());
+    int previousPid = 0;
+    for (const ProcessRow& row : snapshot.processes) {
+        enc.signedVarint(row.pid - previousPid);
+        previousPid = row.pid;
+        enc.signedVarint(row.ppid);
+        enc.bytes(&row.state, 1);
+        enc.string(row.name, strnlen(row.name, sizeof(row.name)));
+        enc.varint(row.owner ? m_owners[row.owner.get()].second + 1 : 0);
+        enc.f32(static_cast<float>(row.cpuPercent));
+        enc.signedVarint(row.memoryKb);
+        enc.signedVarint(row.threads);
+        enc.signedVarint(row.numaNode);
+        enc.varint(row.hasIo ? static_cast<unsigned>(RowHasIo) : 0u);
+        if (row.hasIo) {
+            enc.f32(static_cast<float>(row.readBytesPerSec));
+            enc.f32(static_cast<float>(row.writeBytesPerSec));
+        }
+    }
+    enc.doubles(snapshot.perNodeProcessCpuPercent);
+    enc.signedVarint(snapshot.processCount);
+    enc.signedVarint(snapshot.totalThreads);
+
+    putUint32(m_buffer.data(), static_cast<uint32_t>(m_buffer.size() - 4));
+    return m_buffer;
+}
+
+bool SnapshotWriter::write(const StatsSnapshot& snapshot) {
+    if (!m_file) {
+        return false;
+    }
+    const std::vector<uint8_t>& record = encode(snapshot);
+    if (std::fwrite(record.data(), 1, record.size(), m_file) != record.size()
+        || std::fflush(m_file) != 0) {
+        m_error = std::string("cannot write recording: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+SnapshotReader::~SnapshotReader() {
+    close();
+}
+
+bool SnapshotReader::open(const std::string& path) {
+    close();
+    m_error.clear();
+    m_mountPaths.clear();
+    m_owners.clear();
+
+    m_file = std::fopen(path.c_str(), "rbe");
+    if (!m_file) {
+        m_error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    return readHeader(path);
+}
+
+bool SnapshotReader::connect(const std::string& socketPath) {
+    close();
+    m_error.clear();
+    m_mountPaths.clear();
+    m_owners.clear();
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        m_error = "socket path too long: " + socketPath;
+        return false;
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        m_error = "cannot connect to " + socketPath + ": " + std::strerror(errno);
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+    m_file = fdopen(fd, "rb");
+    if (!m_file) {
+        m_error = std::string("fdopen: ") + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    // Unbuffered, so every byte stdio has read was asked for: a poller on
+    // the descriptor never misses a record already sitting in a buffer.
+    setvbuf(m_file, nullptr, _IONBF, 0);
+    return readHeader(socketPath);
+}
+
+int SnapshotReader::fd() const {
+    return m_file ? fileno(m_file) : -1;
+}
+
+bool SnapshotReader::requestPlan(unsigned metrics, unsigned processFields) {
+    uint8_t request[8];
+    putUint32(request, metrics);
+    putUint32(request + 4, processFields);
+    int socketFd = fd();
+    return socketFd >= 0 && send(socketFd, request, sizeof(request), MSG_NOSIGNAL) == sizeof(request);
+}
+
+bool SnapshotReader::readHeader(const std::string& path) {
+    char magic[sizeof(kRecordingMagic)];
+    uint8_t size[4];
+    if (std::fread(magic, 1, sizeof(magic), m_file) != sizeof(magic)
+        || std::memcmp(magic, kRecordingMagic, sizeof(magic)) != 0
+        || std::fread(size, 1, sizeof(size), m_file) != sizeof(size)) {
+        m_error = path + " is not a recording";
+        close();
+        return false;
+    }
+    m_buffer.resize(std::min(getUint32(size), kMaxRecordSize));
+    Decoder dec{m_buffer.data(), m_buffer.data() + m_buffer.size()};
+    if (std::fread(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size()
+        || dec.varint() != kRecordingVersion) {
+        m_error = path + " is damaged or from another version";
+        close();
+        return false;
+    }
+    m_mountPaths.resize(dec.count(1));
+    for (std::string& mountPath : m_mountPaths) {
+        dec.string(mountPath);
+    }
+    if (!dec.ok) {
+        m_error = path + " has a damaged header";
+        close();
+        return false;
+    }
+    m_firstRecord = std::ftell(m_file);
+    return true;
+}
+
+void SnapshotReader::close() {
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool SnapshotReader::rewind() {
+    m_owners.clear();
+    return m_file && std::fseek(m_file, m_firstRecord, SEEK_SET) == 0;
+}
+
+bool SnapshotReader::next(StatsSnapshot& out) {
+    m_error.clear();
+    if (!m_file) {
+        return false;
+    }
+    uint8_t size[4];
+    size_t got = std::fread(size, 1, sizeof(size), m_file);
+    if (got == 0 && std::feof(m_file)) {
+        return false;
+    }
+    uint32_t recordSize = got == sizeof(size) ? getUint32(size) : 0;
+    if (recordSize == 0 || recordSize > kMaxRecordSize) {
+        m_error = "recording ends in a damaged record";
+        return false;
+    }
+    m_buffer.resize(recordSize);
+    if (std::fread(m_buffer.data(), 1, recordSize, m_file) != recordSize) {
+        // A recording cut short by a crash; what came before still counts.
+        m_error = "recording ends in a partial record";
+        return false;
+    }
+    return decode(m_buffer.data(), m_buffer.size(), out);
+}
+
+bool SnapshotReader::decode(const uint8_t* data, size_t size, StatsSnapshot& out) {
+    Decoder dec{data, data + size};
+
+    out.metrics = static_cast<unsigned>(dec.varint());
+    out.timestamp = dec.f64();
+    out.intervalSec = dec.f64();
+    out.cpuUsagePercent = dec.f64();
+    dec.doubles(out.perCpuUsagePercent);
+    dec.doubles(out.perSocketUsagePercent);
+    dec.doubles(out.perNodeUsagePercent);
+    dec.doubles(out.cpuFreq.perCpuMhz);
+    out.cpuFreq.minMhz = dec.f64();
+    out.cpuFreq.avgMhz = dec.f64();
+    out.cpuFreq.maxMhz = dec.f64();
+    out.cpuFreq.ratedMaxMhz = dec.f64();
+    dec.string(out.uptime);
+
+    for (long MemInfo::* field : kMemInfoFields) {
+        out.memInfo.*field = static_cast<long>(dec.signedVarint());
+    }
+    out.memUsagePercent = dec.f64();
+
+    out.diskActivePercent = dec.f64();
+    out.disks.resize(dec.count(1));
+    for (DiskSample& disk : out.disks) {
+        dec.string(disk.mountPath);
+        dec.string(disk.deviceName);
+        disk.activePercent = dec.f64();
+        disk.readBytesPerSec = dec.f64();
+        disk.writeBytesPerSec = dec.f64();
+        disk.counters = DiskCounters();
+        disk.counters.major = static_cast<unsigned>(dec.varint());
+        disk.counters.minor = static_cast<unsigned>(dec.varint());
+        dec.string(disk.counters.name, sizeof(disk.counters.name) - 1);
+        for (uint64_t DiskCounters::* field : kDiskCounterFields) {
+            disk.counters.*field = dec.varint();
+        }
+        disk.fsInfo.total = static_cast<long>(dec.signedVarint());
+        disk.fsInfo.free = static_cast<long>(dec.signedVarint());
+    }
+
+    out.netSendBitsPerSec = dec.f64();
+    out.netRecvBitsPerSec = dec.f64();
+
+    size_t newOwners = dec.count(2);
+    for (size_t i = 0; i < newOwners && dec.ok; ++i) {
+        size_t id = static_cast<size_t>(dec.varint());
+        std::string name;
+        dec.string(name);
+        if (id > m_owners.size() + newOwners) {
+            dec.ok = false;
+            break;
+        }
+        if (id >= m_owners.size()) {
+            m_owners.resize(id + 1);
+        }
+        m_owners[id] = std::make_shared<const std::string>(std::move(name));
+    }
+
+    out.processes.resize(dec.count(8));
+    int pid = 0;
+    for (ProcessRow& row : out.processes) {
+        row = ProcessRow();
+        pid += static_cast<int>(dec.signedVarint());
+        row.pid = pid;
+        row.ppid = static_cast<int>(dec.signedVarint());
+        dec.bytes(&row.state, 1);
+        dec.string(row.name, sizeof(row.name) - 1);
+        uint64_t owner = dec.varint();
+        if (owner > 0 && owner <= m_owners.size()) {
+            row.owner = m_owners[owner - 1];
+        }
+        row.cpuPercent = dec.f32();
+        row.memoryKb = static_cast<long>(dec.signedVarint());
+        row.threads = static_cast<long>(dec.signedVarint());
+        row.numaNode = static_cast<int>(dec.signedVarint());
+        row.hasIo = dec.varint() & RowHasIo;
+        if (row.hasIo) {
+            row.readBytesPerSec = dec.f32();
+            row.writeBytesPerSec = dec.f32();
+        }
+    }
+    dec.doubles(out.perNodeProcessCpuPercent);
+    out.processCount = static_cast<long>(dec.signedVarint());
+    out.totalThreads = static_cast<long>(dec.signedVarint());
+
+    if (!dec.ok || dec.p != dec.end) {
+        m_error = "damaged record";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,214 @@
+#include "headers/SnapshotServer.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Queued bytes after which a viewer is considered gone: a few ticks of a
+// very large process list.
+static const size_t kMaxBacklog = 16u << 20;
+
+SnapshotServer::~SnapshotServer() {
+    close();
+}
+
+std::string SnapshotServer::defaultSocketPath() {
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir && *runtimeDir) {
+        return std::string(runtimeDir) + "/guitaskmanager.sock";
+    }
+    return "/tmp/guitaskmanager-" + std::to_string(getuid()) + ".sock";
+}
+
+bool SnapshotServer::listen(const std::string& path, const std::vector<std::string>& mountPaths) {
+    close();
+    m_error.clear();
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        m_error = "socket path too long: " + path;
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    // Only replace a socket nobody answers on, and never anything else.
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0) {
+        SnapshotReader probe;
+        if (!S_ISSOCK(st.st_mode) || probe.connect(path)) {
+            m_error = path + " is in use";
+            return false;
+        }
+        unlink(path.c_str());
+    }
+
+    // Created 0600 rather than chmodded after bind(), which would leave a
+    // window in which another user on the machine could connect. The umask
+    // is process-wide; the daemon listens before it starts any thread.
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    bool bound = false;
+    if (m_listenFd >= 0) {
+        mode_t oldMask = umask(077);
+        bound = bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        umask(oldMask);
+    }
+    if (!bound || ::listen(m_listenFd, 16) != 0) {
+        m_error = "cannot listen on " + path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    m_path = path;
+    m_header = SnapshotWriter::encodeHeader(mountPaths);
+    return true;
+}
+
+void SnapshotServer::close() {
+    while (!m_clients.empty()) {
+        drop(m_clients.size() - 1);
+    }
+    if (m_listenFd >= 0) {
+        ::close(m_listenFd);
+        m_listenFd = -1;
+    }
+    if (!m_path.empty()) {
+        unlink(m_path.c_str());
+        m_path.clear();
+    }
+}
+
+unsigned SnapshotServer::metrics() const {
+    unsigned metrics = 0;
+    for (const Client& client : m_clients) {
+        metrics |= client.metrics;
+    }
+    return metrics;
+}
+
+unsigned SnapshotServer::processFields() const {
+    unsigned fields = 0;
+    for (const Client& client : m_clients) {
+        fields |= client.processFields;
+    }
+    return fields;
+}
+
+void SnapshotServer::poll(int timeoutMs) {
+    if (m_listenFd < 0) {
+        return;
+    }
+
+    m_pollFds.clear();
+    m_pollFds.push_back({m_listenFd, POLLIN, 0});
+    for (const Client& client : m_clients) {
+        short events = POLLIN;
+        if (client.outSent < client.out.size()) events |= POLLOUT;
+        m_pollFds.push_back({client.fd, events, 0});
+    }
+
+    if (::poll(m_pollFds.data(), m_pollFds.size(), timeoutMs) <= 0) {
+        return;
+    }
+
+    // Back to front, so dropping a viewer does not shift the ones not yet
+    // looked at. The descriptors line up with m_clients shifted by one.
+    for (size_t i = m_clients.size(); i-- > 0;) {
+        short revents = m_pollFds[i + 1].revents;
+        bool alive = true;
+        if (revents & (POLLIN | POLLHUP | POLLERR)) {
+            alive = receive(m_clients[i]);
+        }
+        if (alive && (revents & POLLOUT)) {
+            alive = flush(m_clients[i]);
+        }
+        if (!alive) {
+            drop(i);
+        }
+    }
+    if (m_pollFds[0].revents & POLLIN) {
+        accept();
+    }
+}
+
+void SnapshotServer::accept() {
+    for (;;) {
+        int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        Client client;
+        client.fd = fd;
+        client.out = m_header;
+        m_clients.push_back(std::move(client));
+        // The newcomer has not seen any owner names yet.
+        m_encoder.restartOwners();
+        if (!flush(m_clients.back())) {
+            drop(m_clients.size() - 1);
+        }
+    }
+}
+
+bool SnapshotServer::receive(Client& client) {
+    uint8_t buffer[256];
+    for (;;) {
+        ssize_t got = recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (got == 0) {
+            return false;
+        }
+        if (got < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        for (ssize_t i = 0; i < got; ++i) {
+            client.request[client.requestFill++] = buffer[i];
+            if (client.requestFill == sizeof(client.request)) {
+                client.metrics = 0;
+                client.processFields = 0;
+                for (int b = 0; b < 4; ++b) {
+                    client.metrics |= static_cast<unsigned>(client.request[b]) << (8 * b);
+                    client.processFields |= static_cast<unsigned>(client.request[4 + b]) << (8 * b);
+                }
+                client.requestFill = 0;
+            }
+        }
+    }
+}
+
+bool SnapshotServer::flush(Client& client) {
+    while (client.outSent < client.out.size()) {
+        ssize_t sent = send(client.fd, client.out.data() + client.outSent,
+                            client.out.size() - client.outSent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        client.outSent += static_cast<size_t>(sent);
+    }
+    client.out.clear();
+    client.outSent = 0;
+    return true;
+}
+
+void SnapshotServer::drop(size_t index) {
+    ::close(m_clients[index].fd);
+    m_clients.erase(m_clients.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+void SnapshotServer::publish(const StatsSnapshot& snapshot) {
+    if (m_clients.empty()) {
+        return;
+    }
+    const std::vector<uint8_t>& record = m_encoder.encode(snapshot);
+    for (size_t i = m_clients.size(); i-- > 0;) {
+        Client& client = m_clients[i];
+        if (client.out.size() - client.outSent + record.size() > kMaxBacklog) {
+            drop(i);
+            continue;
+        }
+        client.out.insert(client.out.end(), record.begin(), record.end());
+        if (!flush(client)) {
+            drop(i);
+        }
+    }
+}
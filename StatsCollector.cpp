@@ -0,0 +1,226 @@
+#include "headers/StatsCollector.h"
+#include <QDebug>
+#include <stdexcept>
+
+StatsCollector::StatsCollector(std::vector<std::string> mountPaths, int intervalMs, unsigned processWorkers)
+    : m_mountPaths(std::move(mountPaths))
+    , m_intervalMs(intervalMs)
+    , m_processWorkers(processWorkers)
+    , m_metrics(SamplePlan().metrics)
+    , m_processFields(SamplePlan().processFields)
+{
+}
+
+StatsCollector::~StatsCollector() = default;
+
+void StatsCollector::setJournal(std::unique_ptr<MetricJournal> journal)
+{
+    m_journal = std::move(journal);
+}
+
+void StatsCollector::setRecorder(std::unique_ptr<SnapshotWriter> recorder)
+{
+    m_recorder = std::move(recorder);
+    m_recordEverything = m_recorder != nullptr;
+}
+
+void StatsCollector::setReplay(std::unique_ptr<SnapshotReader> reader, double speed, bool loop)
+{
+    m_replay = std::move(reader);
+    m_replaySpeed = speed;
+    m_replayLoop = loop;
+}
+
+void StatsCollector::setRemote(std::unique_ptr<SnapshotReader> reader)
+{
+    m_remote = std::move(reader);
+    m_remoteActive.store(true);
+}
+
+void StatsCollector::start()
+{
+    if (m_remote) {
+        // The reader does no buffering of its own, so the notifier sees
+        // every record that has not been read yet.
+        m_remoteNotifier = new QSocketNotifier(m_remote->fd(), QSocketNotifier::Read, this);
+        connect(m_remoteNotifier, &QSocketNotifier::activated, this, &StatsCollector::readRemote);
+        sendRemotePlan();
+        return;
+    }
+    if (m_replay) {
+        m_timer = new QTimer(this);
+        m_timer->setTimerType(Qt::PreciseTimer);
+        m_timer->setSingleShot(true);
+        connect(m_timer, &QTimer::timeout, this, &StatsCollector::replayTick);
+        m_replayClock.start();
+        m_replayNext = readReplay();
+        replayTick();
+        return;
+    }
+    startSampling();
+}
+
+void StatsCollector::startSampling()
+{
+    // Built here so every /proc descriptor and cache lives in the collector thread.
+    m_sampler.reset(new SystemSampler(m_mountPaths, m_processWorkers));
+
+    m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &StatsCollector::sampleNow);
+    m_timer->start(m_intervalMs);
+
+    sampleNow();
+}
+
+void StatsCollector::requestSample()
+{
+    // The daemon sends the next tick by itself.
+    if (m_replay || m_remoteActive.load()) {
+        return;
+    }
+    QMetaObject::invokeMethod(this, "sampleNow", Qt::QueuedConnection);
+}
+
+void StatsCollector::setPlan(const SamplePlan& plan)
+{
+    unsigned oldMetrics = m_metrics.exchange(plan.metrics);
+    unsigned oldFields = m_processFields.exchange(plan.processFields);
+    if (m_remoteActive.load()) {
+        sendRemotePlan();
+    }
+    if ((plan.metrics & ~oldMetrics) || (plan.processFields & ~oldFields)) {
+        requestSample();
+    }
+}
+
+std::shared_ptr<const StatsSnapshot> StatsCollector::latest() const
+{
+    return std::atomic_load(&m_latest);
+}
+
+std::shared_ptr<const StatsSnapshot> StatsCollector::takeLatest()
+{
+    m_pending.store(false);
+    if (m_replayWaiting.exchange(false)) {
+        QMetaObject::invokeMethod(this, "replayTick", Qt::QueuedConnection);
+    }
+    return std::atomic_load(&m_latest);
+}
+
+void StatsCollector::sampleNow()
+{
+    if (!m_sampler) {
+        return;
+    }
+
+    SamplePlan plan;
+    plan.metrics = m_metrics.load();
+    plan.processFields = m_processFields.load();
+    if (m_recorder) {
+        plan.metrics = MetricAll;
+        plan.processFields |= SampleOwner | SampleIo;
+    }
+
+    std::shared_ptr<const StatsSnapshot> snapshot;
+    try {
+        snapshot = m_sampler->collect(plan);
+    } catch (const std::exception& e) {
+        qWarning() << "Sampling failed:" << e.what();
+        return;
+    }
+
+    deliver(std::move(snapshot));
+}
+
+void StatsCollector::deliver(std::shared_ptr<const StatsSnapshot> snapshot)
+{
+    if (m_journal) {
+        m_journal->append(*snapshot, m_mountPaths);
+    }
+    if (m_recorder && !m_recorder->write(*snapshot)) {
+        qWarning() << "Recording stopped:" << QString::fromStdString(m_recorder->error());
+        m_recorder.reset();
+    }
+
+    publish(std::move(snapshot));
+}
+
+void StatsCollector::sendRemotePlan()
+{
+    unsigned metrics = m_metrics.load();
+    unsigned fields = m_processFields.load();
+    if (m_recordEverything) {
+        metrics = MetricAll;
+        fields |= SampleOwner | SampleIo;
+    }
+    // A failed send shows up as a failed read on the collector thread.
+    m_remote->requestPlan(metrics, fields);
+}
+
+void StatsCollector::readRemote()
+{
+    std::shared_ptr<StatsSnapshot> snapshot = std::make_shared<StatsSnapshot>();
+    if (m_remote->next(*snapshot)) {
+        deliver(std::move(snapshot));
+        return;
+    }
+
+    qWarning() << "Lost the collector daemon:"
+               << QString::fromStdString(m_remote->error().empty() ? "connection closed" : m_remote->error())
+               << "- sampling locally";
+    m_remoteNotifier->setEnabled(false);
+    m_remoteActive.store(false);
+    startSampling();
+}
+
+void StatsCollector::publish(std::shared_ptr<const StatsSnapshot> snapshot)
+{
+    std::atomic_store(&m_latest, std::move(snapshot));
+
+    if (!m_pending.exchange(true)) {
+        emit snapshotReady();
+    }
+}
+
+std::shared_ptr<StatsSnapshot> StatsCollector::readReplay()
+{
+    std::shared_ptr<StatsSnapshot> snapshot = std::make_shared<StatsSnapshot>();
+    if (!m_replay->next(*snapshot)) {
+        if (!m_replay->error().empty()) {
+            qWarning() << "Replay:" << QString::fromStdString(m_replay->error());
+        }
+        if (!m_replayLoop || m_replayed == 0 || !m_replay->rewind() || !m_replay->next(*snapshot)) {
+            return nullptr;
+        }
+        // Carry on one interval after where the last pass ended.
+        double interval = snapshot->intervalSec > 0.0 ? snapshot->intervalSec : 1.0;
+        m_replayOffset = m_replayEnd + interval - snapshot->timestamp;
+    }
+    snapshot->timestamp += m_replayOffset;
+    m_replayEnd = snapshot->timestamp;
+    return snapshot;
+}
+
+void StatsCollector::replayTick()
+{
+    std::shared_ptr<StatsSnapshot> current = std::move(m_replayNext);
+    if (!current) {
+        emit replayFinished(m_replayed, m_replayClock.elapsed() / 1000.0);
+        return;
+    }
+    double recordedTime = current->timestamp;
+    ++m_replayed;
+    m_replayNext = readReplay();
+
+    if (m_replaySpeed > 0.0) {
+        // A finished replay still reports itself on the next timeout.
+        double gapMs = m_replayNext ? (m_replayNext->timestamp - recordedTime) * 1000.0 / m_replaySpeed : 0.0;
+        m_timer->start(static_cast<int>(qBound(0.0, gapMs, 60000.0)));
+    } else if (m_replayNext) {
+        m_replayWaiting.store(true);
+    } else {
+        QMetaObject::invokeMethod(this, "replayTick", Qt::QueuedConnection);
+    }
+    publish(std::move(current));
+}
@@ -0,0 +1,212 @@
+#include "headers/SystemSampler.h"
+#include <cstring>
+
+// A device that disappeared and came back restarts its counters from zero.
+static uint64_t counterDelta(uint64_t current, uint64_t previous) {
+    return current >= previous ? current - previous : 0;
+}
+
+SystemSampler::SystemSampler(std::vector<std::string> mountPaths, unsigned processWorkers,
+                             const SystemRoots& roots)
+    : m_parser(roots)
+    , m_processSampler(roots, processWorkers)
+    , m_freqSampler(roots)
+    , m_topology(CpuTopology::read(roots)) {
+    m_parser.getDiskStatsSnapshot(m_diskStats);
+    for (const std::string& path : mountPaths) {
+        DiskState disk;
+        disk.mountPath = path;
+        disk.deviceName = m_parser.getDeviceForMountPoint(path);
+        disk.prevCounters = lookupDisk(disk.deviceName, disk.statsIndex);
+        m_disks.push_back(disk);
+    }
+    m_primaryDisk = m_parser.wholeDiskName(m_parser.getPrimaryDiskName());
+    m_prevPrimaryDisk = lookupDisk(m_primaryDisk, m_primaryDiskIndex);
+
+    m_prevCpuTimes = m_parser.getCpuTimes();
+    m_prevNetStats = m_parser.getNetworkStats();
+    m_prevProcessCpuTotal = m_prevCpuTimes.totalTime();
+    m_lastSample = std::chrono::steady_clock::now();
+    m_lastProcessSample = m_lastSample;
+}
+
+std::shared_ptr<const StatsSnapshot> SystemSampler::collect(const SamplePlan& plan) {
+    auto snapshot = std::make_shared<StatsSnapshot>();
+    snapshot->metrics = plan.metrics;
+
+    auto now = std::chrono::steady_clock::now();
+    double timeIntervalSec = std::chrono::duration<double>(now - m_lastSample).count();
+    if (timeIntervalSec <= 0.0) timeIntervalSec = 1.0;
+    m_lastSample = now;
+
+    snapshot->intervalSec = timeIntervalSec;
+    snapshot->timestamp = std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    CpuTimes currentCpuTimes;
+    if (plan.metrics & MetricPerCpu) {
+        currentCpuTimes = m_parser.getPerCpuTimes(m_perCpuTimes);
+        collectPerCpu(*snapshot);
+    } else {
+        currentCpuTimes = m_parser.getCpuTimes();
+    }
+    long deltaTotal = currentCpuTimes.totalTime() - m_prevCpuTimes.totalTime();
+    long deltaIdle = currentCpuTimes.totalIdleTime() - m_prevCpuTimes.totalIdleTime();
+    if (deltaTotal > 0) {
+        snapshot->cpuUsagePercent = (1.0 - (static_cast<double>(deltaIdle) / static_cast<double>(deltaTotal))) * 100.0;
+    }
+    m_prevCpuTimes = currentCpuTimes;
+    if (plan.metrics & MetricCpuDetails) {
+        m_freqSampler.sample(snapshot->cpuFreq);
+        snapshot->uptime = m_parser.getUptime();
+        if (!(plan.metrics & MetricProcesses)) {
+            m_parser.getTaskCounts(snapshot->processCount, snapshot->totalThreads);
+        }
+    }
+
+    snapshot->memInfo = m_parser.getMemoryStats();
+    if (snapshot->memInfo.memTotal > 0) {
+        snapshot->memUsagePercent = (static_cast<double>(snapshot->memInfo.memUsed()) / snapshot->memInfo.memTotal) * 100.0;
+    }
+
+    // One parse of /proc/diskstats serves the primary disk and every page.
+    m_parser.getDiskStatsSnapshot(m_diskStats);
+    DiskCounters primary = lookupDisk(m_primaryDisk, m_primaryDiskIndex);
+    uint64_t globalDeltaIOTime = counterDelta(primary.msDoingIo, m_prevPrimaryDisk.msDoingIo);
+    snapshot->diskActivePercent = (static_cast<double>(globalDeltaIOTime) / (timeIntervalSec * 1000.0)) * 100.0;
+    if (snapshot->diskActivePercent > 100.0) snapshot->diskActivePercent = 100.0;
+    m_prevPrimaryDisk = primary;
+
+    snapshot->disks.reserve(m_disks.size());
+    for (DiskState& disk : m_disks) {
+        DiskCounters counters = lookupDisk(disk.deviceName, disk.statsIndex);
+        const DiskCounters& prev = disk.prevCounters;
+
+        DiskSample sample;
+        sample.mountPath = disk.mountPath;
+        sample.deviceName = disk.deviceName;
+        sample.readBytesPerSec = static_cast<double>(counterDelta(counters.sectorsRead, prev.sectorsRead)) * 512.0 / timeIntervalSec;
+        sample.writeBytesPerSec = static_cast<double>(counterDelta(counters.sectorsWritten, prev.sectorsWritten)) * 512.0 / timeIntervalSec;
+
+        uint64_t deltaIOTime = counterDelta(counters.msDoingIo, prev.msDoingIo);
+        sample.activePercent = (static_cast<double>(deltaIOTime) / (timeIntervalSec * 1000.0)) * 100.0;
+        if (sample.activePercent > 100.0) sample.activePercent = 100.0;
+        sample.counters = counters;
+
+        if (plan.metrics & MetricFilesystems) {
+            sample.fsInfo = m_parser.getFilesystemStats(disk.mountPath);
+        }
+
+        disk.prevCounters = counters;
+        snapshot->disks.push_back(sample);
+    }
+
+    NetStats currentNetStats = m_parser.getNetworkStats();
+    snapshot->netSendBitsPerSec = (currentNetStats.bytesSent - m_prevNetStats.bytesSent) * 8.0 / timeIntervalSec;
+    snapshot->netRecvBitsPerSec = (currentNetStats.bytesReceived - m_prevNetStats.bytesReceived) * 8.0 / timeIntervalSec;
+    m_prevNetStats = currentNetStats;
+
+    if (plan.metrics & MetricProcesses) {
+        collectProcesses(plan.processFields, currentCpuTimes.totalTime(), now, *snapshot);
+    }
+
+    return snapshot;
+}
+
+DiskCounters SystemSampler::lookupDisk(const std::string& name, int& hint) const {
+    hint = m_diskStats.indexOf(name, hint);
+    return hint >= 0 ? m_diskStats.devices[hint] : DiskCounters();
+}
+
+static void perCpuUsage(const long* __restrict active, const long* __restrict total,
+                        const long* __restrict prevActive, const long* __restrict prevTotal,
+                        double* __restrict usage, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        double deltaTotal = static_cast<double>(total[i] - prevTotal[i]);
+        double deltaActive = static_cast<double>(active[i] - prevActive[i]);
+        usage[i] = deltaTotal > 0.0 ? deltaActive * 100.0 / deltaTotal : 0.0;
+    }
+}
+
+void SystemSampler::collectPerCpu(StatsSnapshot& snapshot) {
+    size_t count = m_perCpuTimes.size();
+    m_cpuActive.resize(count);
+    m_cpuTotal.resize(count);
+    m_prevCpuActive.resize(count, 0);
+    m_prevCpuTotal.resize(count, 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        m_cpuActive[i] = m_perCpuTimes[i].totalActiveTime();
+        m_cpuTotal[i] = m_perCpuTimes[i].totalTime();
+    }
+
+    snapshot.perCpuUsagePercent.resize(count);
+    perCpuUsage(m_cpuActive.data(), m_cpuTotal.data(), m_prevCpuActive.data(), m_prevCpuTotal.data(),
+                snapshot.perCpuUsagePercent.data(), count);
+
+    m_topology.averageBySocket(snapshot.perCpuUsagePercent, snapshot.perSocketUsagePercent);
+    m_topology.averageByNode(snapshot.perCpuUsagePercent, snapshot.perNodeUsagePercent);
+
+    m_prevCpuActive.swap(m_cpuActive);
+    m_prevCpuTotal.swap(m_cpuTotal);
+}
+
+void SystemSampler::collectProcesses(unsigned fields, long cpuTotal,
+                                     std::chrono::steady_clock::time_point now,
+                                     StatsSnapshot& snapshot) {
+    // The process list may have been skipped for a while, so its rates use
+    // their own baseline rather than the previous tick's.
+    long deltaTotal = cpuTotal - m_prevProcessCpuTotal;
+    double timeIntervalSec = std::chrono::duration<double>(now - m_lastProcessSample).count();
+    if (timeIntervalSec <= 0.0) timeIntervalSec = 1.0;
+    m_prevProcessCpuTotal = cpuTotal;
+    m_lastProcessSample = now;
+
+    m_processSampler.sample(fields, m_samples);
+
+    std::unordered_map<int, long> currentProcessJiffies;
+    std::unordered_map<int, IoStats> currentProcessIo;
+    currentProcessJiffies.reserve(m_samples.size());
+
+    snapshot.processes.reserve(m_samples.size());
+    snapshot.perNodeProcessCpuPercent.assign(static_cast<size_t>(m_topology.nodeCount), 0.0);
+    for (const ProcessSample& sample : m_samples) {
+        ProcessRow row;
+        row.pid = sample.pid;
+        row.ppid = sample.ppid;
+        row.state = sample.state;
+        std::memcpy(row.name, sample.name, sizeof(row.name));
+        row.owner = sample.owner;
+        row.memoryKb = sample.memoryKb;
+        row.threads = sample.threads;
+        snapshot.totalThreads += sample.threads;
+
+        currentProcessJiffies[sample.pid] = sample.activeJiffies;
+        long prevJiffies = 0;
+        auto it = m_prevProcessJiffies.find(sample.pid);
+        if (it != m_prevProcessJiffies.end()) prevJiffies = it->second;
+        if (deltaTotal > 0) {
+            row.cpuPercent = (static_cast<double>(sample.activeJiffies - prevJiffies) / static_cast<double>(deltaTotal)) * 100.0;
+        }
+        row.numaNode = m_topology.nodeOf(sample.lastCpu);
+        if (row.numaNode >= 0) {
+            snapshot.perNodeProcessCpuPercent[row.numaNode] += row.cpuPercent;
+        }
+
+        if (sample.hasIo) {
+            row.hasIo = true;
+            currentProcessIo[sample.pid] = sample.io;
+            auto io_it = m_prevProcessIo.find(sample.pid);
+            if (io_it != m_prevProcessIo.end()) {
+                row.readBytesPerSec = static_cast<double>(sample.io.readBytes - io_it->second.readBytes) / timeIntervalSec;
+                row.writeBytesPerSec = static_cast<double>(sample.io.writeBytes - io_it->second.writeBytes) / timeIntervalSec;
+            }
+        }
+
+        snapshot.processes.push_back(row);
+    }
+    snapshot.processCount = static_cast<long>(snapshot.processes.size());
+
+    m_prevProcessJiffies.swap(currentProcessJiffies);
+    m_prevProcessIo.swap(currentProcessIo);
+}
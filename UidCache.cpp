@@ -0,0 +1,97 @@
+#include "headers/UidCache.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <pwd.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+UidCache::UidCache(std::string passwdPath)
+    : m_passwdPath(std::move(passwdPath)) {
+}
+
+void UidCache::load() {
+    m_names.clear();
+    m_loaded = true;
+
+    struct stat st;
+    if (stat(m_passwdPath.c_str(), &st) == 0) {
+        m_mtime = st.st_mtim;
+    } else {
+        m_mtime = {};
+    }
+
+    std::ifstream passwdFile(m_passwdPath);
+    if (!passwdFile.is_open()) {
+        return;
+    }
+
+    std::string line;
+    while (std::getline(passwdFile, line)) {
+        std::stringstream ss(line);
+
+        std::string username, placeholder, currentUid;
+
+        std::getline(ss, username, ':');
+        std::getline(ss, placeholder, ':');
+        std::getline(ss, currentUid, ':');
+
+        try {
+            uid_t uid = static_cast<uid_t>(std::stoul(currentUid));
+            // First entry wins, like the old linear scan.
+            m_names.emplace(uid, std::make_shared<const std::string>(username));
+        } catch (const std::exception& e) {
+            continue;
+        }
+    }
+}
+
+void UidCache::revalidate() {
+    m_lastCheck = std::chrono::steady_clock::now();
+
+    struct stat st;
+    struct timespec mtime = {};
+    if (stat(m_passwdPath.c_str(), &st) == 0) {
+        mtime = st.st_mtim;
+    }
+    if (!m_loaded || mtime.tv_sec != m_mtime.tv_sec || mtime.tv_nsec != m_mtime.tv_nsec) {
+        load();
+    }
+}
+
+OwnerHandle UidCache::resolveMiss(uid_t uid) {
+    long bufSize = sysconf(_SC_GETPW_R_SIZE_MAX);
+    std::vector<char> buf(bufSize > 0 ? static_cast<size_t>(bufSize) : 16384);
+
+    struct passwd pwd;
+    struct passwd* result = nullptr;
+    OwnerHandle name;
+    if (getpwuid_r(uid, &pwd, buf.data(), buf.size(), &result) == 0 && result) {
+        name = std::make_shared<const std::string>(result->pw_name);
+    } else {
+        name = std::make_shared<const std::string>(std::to_string(uid));
+    }
+    m_names.emplace(uid, name);
+    return name;
+}
+
+OwnerHandle UidCache::lookup(uid_t uid) {
+    auto now = std::chrono::steady_clock::now();
+    if (!m_loaded || now - m_lastCheck >= std::chrono::seconds(1)) {
+        revalidate();
+    }
+
+    auto it = m_names.find(uid);
+    if (it != m_names.end()) {
+        return it->second;
+    }
+    return resolveMiss(uid);
+}
+
+OwnerHandle UidCache::lookup(const std::string& uid) {
+    try {
+        return lookup(static_cast<uid_t>(std::stoul(uid)));
+    } catch (const std::exception& e) {
+        return std::make_shared<const std::string>(uid);
+    }
+}
@@ -0,0 +1,110 @@
+#include "headers/WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(unsigned workers) {
+    if (workers == 0) workers = 1;
+    for (unsigned i = 0; i < workers; ++i) {
+        m_queues.emplace_back(new Queue());
+    }
+    for (unsigned i = 1; i < workers; ++i) {
+        m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+bool WorkStealingPool::runOne(unsigned worker) {
+    size_t index = 0;
+    bool found = false;
+
+    {
+        Queue& own = *m_queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.items.empty()) {
+            index = own.items.back();
+            own.items.pop_back();
+            found = true;
+        }
+    }
+
+    for (size_t i = 1; !found && i < m_queues.size(); ++i) {
+        Queue& victim = *m_queues[(worker + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty()) {
+            index = victim.items.front();
+            victim.items.pop_front();
+            found = true;
+        }
+    }
+
+    if (found) {
+        (*m_task)(index, worker);
+    }
+    return found;
+}
+
+void WorkStealingPool::workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_batch != seen; });
+            if (m_stop) {
+                return;
+            }
+            seen = m_batch;
+        }
+
+        while (runOne(worker)) {
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_busy == 0) {
+                m_done.notify_all();
+            }
+        }
+    }
+}
+
+void WorkStealingPool::run(size_t count, const std::function<void(size_t, unsigned)>& task) {
+    if (count == 0) {
+        return;
+    }
+
+    m_task = &task;
+    if (m_threads.empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i, 0);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        Queue& queue = *m_queues[i % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.items.push_back(i);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_busy = static_cast<unsigned>(m_threads.size());
+        ++m_batch;
+    }
+    m_wake.notify_all();
+
+    while (runOne(0)) {
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&] { return m_busy == 0; });
+    m_task = nullptr;
+}
@@ -0,0 +1,30 @@
+// Generates a fixture tree that ProcessParser / ProcessSampler can be pointed
+// at through SystemRoots:
+//
+//   MakeProcFixture DIR [processes] [cpus]
+//
+// creates DIR/proc, DIR/sys and DIR/etc.
+
+#include "ProcFixture.h"
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s DIR [processes] [cpus]\n", argv[0]);
+        return 1;
+    }
+
+    std::string dir = argv[1];
+    int processes = argc > 2 ? std::atoi(argv[2]) : 50000;
+    int cpus = argc > 3 ? std::atoi(argv[3]) : 8;
+
+    SystemRoots roots;
+    roots.proc = dir + "/proc";
+    roots.sys = dir + "/sys";
+    roots.etc = dir + "/etc";
+
+    writeSystemFixture(roots, processes, cpus);
+    std::printf("Wrote %d processes and %d CPUs under %s\n", processes, cpus, dir.c_str());
+    return 0;
+}
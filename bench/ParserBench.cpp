@@ -0,0 +1,466 @@
+// Google Benchmark suite for the ProcessParser hot paths and a full
+// refresh sweep. Every benchmark takes one argument: 0 runs against the live
+// /proc, anything else against a generated fixture tree with that many
+// processes. Each result reports heap allocations per iteration next to the
+// wall time.
+
+#include <benchmark/benchmark.h>
+#include "headers/processParser.h"
+#include "headers/ProcessSampler.h"
+#include "headers/SystemSampler.h"
+#include "headers/GpuSampler.h"
+#include "headers/CpuFreqSampler.h"
+#include "headers/MetricJournal.h"
+#include "headers/SnapshotRecording.h"
+#include "headers/MetricsExporter.h"
+#include "ProcFixture.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <new>
+#include <unistd.h>
+
+static std::atomic<size_t> g_allocations{0};
+
+// Every replaceable form of new goes through countedAlloc() and every form
+// of delete through countedFree(), so array, aligned and nothrow allocations
+// are counted too, and each delete matches the new it undoes.
+static void* countedAlloc(std::size_t size, std::size_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) {
+        size = 1;
+    }
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+    void* p = nullptr;
+    return posix_memalign(&p, alignment, size) == 0 ? p : nullptr;
+}
+
+static void countedFree(void* p) noexcept {
+    std::free(p);
+}
+
+static void* countedNew(std::size_t size, std::size_t alignment) {
+    if (void* p = countedAlloc(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+static const std::size_t kDefaultAlign = alignof(std::max_align_t);
+
+void* operator new(std::size_t size) { return countedNew(size, kDefaultAlign); }
+void* operator new[](std::size_t size) { return countedNew(size, kDefaultAlign); }
+void* operator new(std::size_t size, std::align_val_t al) { return countedNew(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return countedNew(size, static_cast<std::size_t>(al)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, kDefaultAlign); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, kDefaultAlign); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, static_cast<std::size_t>(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, static_cast<std::size_t>(al));
+}
+
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(p); }
+
+// Counts allocations between construction and report(), which should be
+// called after the timing loop.
+class AllocationCounter {
+public:
+    explicit AllocationCounter(benchmark::State& state)
+        : m_state(state), m_start(g_allocations.load()) {}
+
+    void report() {
+        m_state.counters["allocs/iter"] = benchmark::Counter(
+            static_cast<double>(g_allocations.load() - m_start), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& m_state;
+    size_t m_start;
+};
+
+// Fixture trees are written once per size and removed at exit.
+class FixtureRegistry {
+public:
+    ~FixtureRegistry() {
+        if (!m_base.empty()) {
+            std::filesystem::remove_all(m_base);
+        }
+    }
+
+    SystemRoots roots(int processes) {
+        if (processes == 0) {
+            return SystemRoots();
+        }
+        auto it = m_roots.find(processes);
+        if (it != m_roots.end()) {
+            return it->second;
+        }
+        if (m_base.empty()) {
+            char tmpl[] = "/tmp/parserbench-XXXXXX";
+            m_base = mkdtemp(tmpl) ? tmpl : "/tmp/parserbench";
+        }
+        std::string dir = m_base + "/" + std::to_string(processes);
+        SystemRoots roots;
+        roots.proc = dir + "/proc";
+        roots.sys = dir + "/sys";
+        roots.etc = dir + "/etc";
+        writeSystemFixture(roots, processes);
+        m_roots.emplace(processes, roots);
+        return roots;
+    }
+
+private:
+    std::string m_base;
+    std::map<int, SystemRoots> m_roots;
+};
+
+static FixtureRegistry g_fixtures;
+
+static void BM_GetCpuTimes(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.getCpuTimes());
+    }
+    allocs.report();
+}
+
+static void BM_GetPerCpuTimes(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    std::vector<CpuTimes> perCpu;
+    parser.getPerCpuTimes(perCpu);
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.getPerCpuTimes(perCpu));
+    }
+    allocs.report();
+    state.counters["cpus"] = static_cast<double>(perCpu.size());
+}
+
+static void BM_GetMemoryStats(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.getMemoryStats());
+    }
+    allocs.report();
+}
+
+static void BM_GetDiskStatsDevice(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    std::string device = parser.getDeviceForMountPoint("/");
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.getDiskStats(device));
+    }
+    allocs.report();
+}
+
+// The whole /proc/diskstats table, as one SystemSampler tick reads it.
+static void BM_GetDiskStatsSnapshot(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    DiskStatsSnapshot snapshot;
+    parser.getDiskStatsSnapshot(snapshot);
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        parser.getDiskStatsSnapshot(snapshot);
+        benchmark::DoNotOptimize(snapshot.devices.data());
+    }
+    allocs.report();
+    state.counters["devices"] = static_cast<double>(snapshot.devices.size());
+}
+
+static void BM_GetNetworkStats(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.getNetworkStats());
+    }
+    allocs.report();
+}
+
+static void BM_GetTotalThreads(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.getTotalThreads());
+    }
+    allocs.report();
+}
+
+static void BM_GetTaskCounts(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    long processes = 0;
+    long threads = 0;
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        parser.getTaskCounts(processes, threads);
+        benchmark::DoNotOptimize(processes);
+        benchmark::DoNotOptimize(threads);
+    }
+    allocs.report();
+    state.counters["processes"] = static_cast<double>(processes);
+}
+
+// Per-process calls cycle through every PID of the tree, one PID per iteration.
+static void BM_GetProcessInfo(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    std::vector<std::string> pids = parser.getPids();
+    size_t next = 0;
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.getProcessInfo(pids[next++ % pids.size()]));
+    }
+    allocs.report();
+}
+
+static void BM_GetProcessActiveJiffies(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    std::vector<std::string> pids = parser.getPids();
+    size_t next = 0;
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.getProcessActiveJiffies(pids[next++ % pids.size()]));
+    }
+    allocs.report();
+}
+
+static void BM_GetProcessIoBytes(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    std::vector<std::string> pids = parser.getPids();
+    size_t next = 0;
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.getProcessIoBytes(pids[next++ % pids.size()]));
+    }
+    allocs.report();
+}
+
+static void BM_ProcessSamplerPass(benchmark::State& state) {
+    ProcessSampler sampler(g_fixtures.roots(state.range(0)), 1);
+    std::vector<ProcessSample> samples;
+    sampler.sample(SampleOwner | SampleIo, samples);
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        sampler.sample(SampleOwner | SampleIo, samples);
+        benchmark::DoNotOptimize(samples.data());
+    }
+    allocs.report();
+    state.counters["processes"] = static_cast<double>(samples.size());
+}
+
+// What the CPU page's clock speed used to cost: all of /proc/cpuinfo per tick.
+static void BM_GetCurrentCpuMhz(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.getCurrentCpuMhz());
+    }
+    allocs.report();
+}
+
+// Every CPU's clock through the cached scaling_cur_freq descriptors.
+static void BM_CpuFreqSample(benchmark::State& state) {
+    CpuFreqSampler sampler(g_fixtures.roots(state.range(0)));
+    CpuFreqSample sample;
+    sampler.sample(sample);
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        sampler.sample(sample);
+        benchmark::DoNotOptimize(sample.avgMhz);
+    }
+    allocs.report();
+    state.counters["cpus"] = static_cast<double>(sample.perCpuMhz.size());
+    state.SetLabel(sampler.usesCpufreq() ? "cpufreq" : "cpuinfo");
+}
+
+// One GPU tick over every card through the sysfs backend; the rocm-smi
+// fallback is left out so a live run measures the same thing on every host.
+static void BM_GpuSamplerSample(benchmark::State& state) {
+    GpuSampler sampler(g_fixtures.roots(state.range(0)), false);
+    std::vector<GpuSample> samples;
+    sampler.sample(samples);
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        sampler.sample(samples);
+        benchmark::DoNotOptimize(samples.data());
+    }
+    allocs.report();
+    state.counters["cards"] = static_cast<double>(samples.size());
+    state.SetLabel(sampler.backendName());
+}
+
+// The per-tick work refreshStats used to do before the sampler existed:
+// one getProcessInfo, getProcessActiveJiffies and getProcessIoBytes per PID.
+static void BM_LegacyRefreshSweep(benchmark::State& state) {
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        for (const std::string& pid : parser.getPids()) {
+            benchmark::DoNotOptimize(parser.getProcessInfo(pid));
+            benchmark::DoNotOptimize(parser.getProcessActiveJiffies(pid));
+            benchmark::DoNotOptimize(parser.getProcessIoBytes(pid));
+        }
+        benchmark::DoNotOptimize(parser.getTotalThreads());
+    }
+    allocs.report();
+}
+
+// Everything one collector tick does, snapshot included.
+static void BM_RefreshSweep(benchmark::State& state) {
+    SystemSampler sampler({"/"}, 1, g_fixtures.roots(state.range(0)));
+    AllocationCounter allocs(state);
+    SamplePlan plan;
+    plan.processFields = SampleOwner | SampleIo;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sampler.collect(plan));
+    }
+    allocs.report();
+}
+
+// A tick with only the always-on counters, as on the Memory or Network page.
+static void BM_RefreshSweepCore(benchmark::State& state) {
+    SystemSampler sampler({"/"}, 1, g_fixtures.roots(state.range(0)));
+    AllocationCounter allocs(state);
+    SamplePlan plan;
+    plan.metrics = MetricCore;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sampler.collect(plan));
+    }
+    allocs.report();
+}
+
+// Writing one tick into the mapped journal.
+// The msync runs on the journal's own thread and is not measured.
+static void BM_JournalAppend(benchmark::State& state) {
+    SystemSampler sampler({"/"}, 1, g_fixtures.roots(state.range(0)));
+    SamplePlan plan;
+    std::shared_ptr<const StatsSnapshot> snapshot = sampler.collect(plan);
+    std::string path = (std::filesystem::temp_directory_path()
+                        / ("ParserBench." + std::to_string(getpid()) + ".journal")).string();
+    std::vector<std::string> diskNames = {"/"};
+    MetricJournal journal;
+    if (!journal.open(path, 3600)) {
+        state.SkipWithError(journal.error().c_str());
+        return;
+    }
+    journal.append(*snapshot, diskNames);
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        journal.append(*snapshot, diskNames);
+    }
+    allocs.report();
+    journal.close();
+    std::filesystem::remove(path);
+}
+
+// Encoding one full tick for a recording, and decoding it for a replay.
+static void BM_SnapshotEncode(benchmark::State& state) {
+    SystemSampler sampler({"/"}, 1, g_fixtures.roots(state.range(0)));
+    SamplePlan plan;
+    plan.processFields = SampleOwner | SampleIo;
+    std::shared_ptr<const StatsSnapshot> snapshot = sampler.collect(plan);
+    SnapshotWriter writer;
+    size_t bytes = writer.encode(*snapshot).size();
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(writer.encode(*snapshot).data());
+    }
+    allocs.report();
+    state.counters["bytes"] = static_cast<double>(bytes);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+static void BM_SnapshotDecode(benchmark::State& state) {
+    SystemSampler sampler({"/"}, 1, g_fixtures.roots(state.range(0)));
+    SamplePlan plan;
+    plan.processFields = SampleOwner | SampleIo;
+    std::shared_ptr<const StatsSnapshot> snapshot = sampler.collect(plan);
+    SnapshotWriter writer;
+    std::vector<uint8_t> record = writer.encode(*snapshot);
+    SnapshotReader reader;
+    StatsSnapshot decoded;
+    if (!reader.decode(record.data() + 4, record.size() - 4, decoded)) {
+        state.SkipWithError(reader.error().c_str());
+        return;
+    }
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        reader.decode(record.data() + 4, record.size() - 4, decoded);
+        benchmark::DoNotOptimize(decoded.processes.data());
+    }
+    allocs.report();
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * record.size()));
+}
+
+// Rendering one tick for the Prometheus exporter. Only the top processes
+// are exported, so the cost should barely follow the process count.
+static void BM_MetricsRender(benchmark::State& state) {
+    SystemSampler sampler({"/"}, 1, g_fixtures.roots(state.range(0)));
+    ProcessParser parser(g_fixtures.roots(state.range(0)));
+    GpuSampler gpuSampler(g_fixtures.roots(state.range(0)), false);
+    SamplePlan plan;
+    plan.metrics = MetricAll;
+    plan.processFields = SampleOwner | SampleIo;
+    std::shared_ptr<const StatsSnapshot> snapshot = sampler.collect(plan);
+    std::vector<InterfaceCounters> interfaces;
+    parser.getInterfaceCounters(interfaces);
+    std::vector<GpuSample> gpus;
+    gpuSampler.sample(gpus);
+    MetricsExporter exporter;
+    std::string body;
+    exporter.render(*snapshot, interfaces, gpus, body);
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+        body.clear();
+        exporter.render(*snapshot, interfaces, gpus, body);
+        benchmark::DoNotOptimize(body.data());
+    }
+    allocs.report();
+    state.counters["bytes"] = static_cast<double>(body.size());
+}
+
+#define PARSER_BENCH_SIZES ->Arg(0)->Arg(1000)->Arg(10000)->Arg(100000)
+
+BENCHMARK(BM_GetCpuTimes) PARSER_BENCH_SIZES;
+BENCHMARK(BM_GetPerCpuTimes) PARSER_BENCH_SIZES;
+BENCHMARK(BM_GetMemoryStats) PARSER_BENCH_SIZES;
+BENCHMARK(BM_GetDiskStatsDevice) PARSER_BENCH_SIZES;
+BENCHMARK(BM_GetDiskStatsSnapshot) PARSER_BENCH_SIZES;
+BENCHMARK(BM_GetNetworkStats) PARSER_BENCH_SIZES;
+BENCHMARK(BM_GetProcessInfo) PARSER_BENCH_SIZES;
+BENCHMARK(BM_GetProcessActiveJiffies) PARSER_BENCH_SIZES;
+BENCHMARK(BM_GetProcessIoBytes) PARSER_BENCH_SIZES;
+BENCHMARK(BM_GetTotalThreads) PARSER_BENCH_SIZES->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GetTaskCounts) PARSER_BENCH_SIZES;
+BENCHMARK(BM_GetCurrentCpuMhz) PARSER_BENCH_SIZES;
+BENCHMARK(BM_CpuFreqSample) PARSER_BENCH_SIZES;
+BENCHMARK(BM_GpuSamplerSample) PARSER_BENCH_SIZES;
+BENCHMARK(BM_ProcessSamplerPass) PARSER_BENCH_SIZES->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LegacyRefreshSweep) PARSER_BENCH_SIZES->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RefreshSweep) PARSER_BENCH_SIZES->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RefreshSweepCore) PARSER_BENCH_SIZES;
+BENCHMARK(BM_JournalAppend) PARSER_BENCH_SIZES;
+BENCHMARK(BM_SnapshotEncode) PARSER_BENCH_SIZES;
+BENCHMARK(BM_SnapshotDecode) PARSER_BENCH_SIZES;
+BENCHMARK(BM_MetricsRender) PARSER_BENCH_SIZES;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,230 @@
+#ifndef PROC_FIXTURE_H
+
+#define PROC_FIXTURE_H
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "headers/processParser.h"
+
+// Writes a synthetic /proc tree with the per-process files ProcessSampler
+// reads, so sampling can be measured reproducibly without a busy host.
+inline void writeProcFixture(const std::string& root, int processes) {
+    std::filesystem::create_directories(root);
+
+    for (int i = 0; i < processes; ++i) {
+        int pid = 1000 + i;
+        std::string dir = root + "/" + std::to_string(pid);
+        std::filesystem::create_directory(dir);
+
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "%d (worker-%d) S 1 %d %d 0 -1 4194560 %d 0 0 0 %d %d 0 0 20 0 %d 0 %d "
+                      "12345678 %d 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 %d 0 0 0 0 0\n",
+                      pid, i % 997, pid, pid, i * 3, i % 5000, i % 700, 1 + i % 8,
+                      10000 + i, 400 + i % 2000, i % 8);
+        std::ofstream(dir + "/stat") << line;
+
+        std::snprintf(line, sizeof(line), "%d %d %d 100 0 %d 0\n",
+                      20000 + i, 400 + i % 2000, 200, 3000);
+        std::ofstream(dir + "/statm") << line;
+
+        std::ofstream status(dir + "/status");
+        status << "Name:\tworker-" << (i % 997) << "\n"
+               << "Umask:\t0022\n"
+               << "State:\tS (sleeping)\n"
+               << "Tgid:\t" << pid << "\n"
+               << "Ngid:\t0\n"
+               << "Pid:\t" << pid << "\n"
+               << "PPid:\t1\n"
+               << "TracerPid:\t0\n"
+               << "Uid:\t" << (i % 50) << "\t" << (i % 50) << "\t" << (i % 50) << "\t" << (i % 50) << "\n"
+               << "Gid:\t0\t0\t0\t0\n"
+               << "FDSize:\t64\n"
+               << "VmPeak:\t   80000 kB\n"
+               << "VmSize:\t   80000 kB\n"
+               << "VmRSS:\t    " << (400 + i % 2000) * 4 << " kB\n"
+               << "Threads:\t" << (1 + i % 8) << "\n";
+
+        std::ofstream io(dir + "/io");
+        io << "rchar: " << i * 4096L << "\n"
+           << "wchar: " << i * 1024L << "\n"
+           << "syscr: " << i << "\n"
+           << "syscw: " << i << "\n"
+           << "read_bytes: " << i * 8192L << "\n"
+           << "write_bytes: " << i * 2048L << "\n"
+           << "cancelled_write_bytes: 0\n";
+    }
+}
+
+// An amdgpu card with the device and hwmon attributes GpuSampler reads.
+inline void writeAmdGpuFixture(const std::string& cardDir) {
+    std::string device = cardDir + "/device";
+    std::string hwmon = device + "/hwmon/hwmon3";
+    std::filesystem::create_directories(hwmon);
+
+    std::ofstream(device + "/uevent") << "DRIVER=amdgpu\nPCI_CLASS=30000\nPCI_ID=1002:73BF\n";
+    std::ofstream(device + "/vendor") << "0x1002\n";
+    std::ofstream(device + "/device") << "0x73bf\n";
+    std::ofstream(device + "/product_name") << "Fixture Radeon\n";
+    std::ofstream(device + "/gpu_busy_percent") << "37\n";
+    std::ofstream(device + "/mem_info_vram_total") << "17163091968\n";
+    std::ofstream(device + "/mem_info_vram_used") << "1073741824\n";
+    std::ofstream(hwmon + "/temp1_input") << "54000\n";
+    std::ofstream(hwmon + "/fan1_input") << "1180\n";
+    std::ofstream(hwmon + "/power1_average") << "42000000\n";
+}
+
+// An Intel discrete card: a GT clock, and power only as an energy counter.
+inline void writeIntelGpuFixture(const std::string& cardDir) {
+    std::string device = cardDir + "/device";
+    std::string hwmon = device + "/hwmon/hwmon4";
+    std::filesystem::create_directories(hwmon);
+
+    std::ofstream(device + "/uevent") << "DRIVER=i915\nPCI_CLASS=30000\nPCI_ID=8086:56A0\n";
+    std::ofstream(device + "/vendor") << "0x8086\n";
+    std::ofstream(device + "/device") << "0x56a0\n";
+    std::ofstream(cardDir + "/gt_act_freq_mhz") << "2050\n";
+    std::ofstream(hwmon + "/energy1_input") << "123456789\n";
+}
+
+// Writes a complete fixture: the per-process tree above plus the system-wide
+// procfs files, an amdgpu and an Intel card in the sysfs drm class and a
+// passwd file whose UIDs match the ones used in the per-process status files.
+inline void writeSystemFixture(const SystemRoots& roots, int processes, int cpus = 8) {
+    writeProcFixture(roots.proc, processes);
+    std::filesystem::create_directories(roots.proc + "/net");
+    writeAmdGpuFixture(roots.sys + "/class/drm/card0");
+    std::filesystem::create_directories(roots.sys + "/class/drm/card0-DP-1");
+    writeIntelGpuFixture(roots.sys + "/class/drm/card1");
+    std::filesystem::create_directories(roots.etc);
+
+    {
+        std::ofstream stat(roots.proc + "/stat");
+        stat << "cpu  " << 10000L * cpus << " 100 " << 5000L * cpus << " " << 90000L * cpus
+             << " 300 0 200 0 0 0\n";
+        for (int cpu = 0; cpu < cpus; ++cpu) {
+            stat << "cpu" << cpu << " " << 10000 + cpu * 10 << " 12 " << 5000 + cpu
+                 << " " << 90000 - cpu * 7 << " 37 0 25 0 0 0\n";
+        }
+        stat << "intr 123456789\nctxt 987654321\nbtime 1700000000\n"
+             << "processes " << processes << "\nprocs_running 3\nprocs_blocked 0\n";
+    }
+
+    for (int cpu = 0; cpu < cpus; ++cpu) {
+        std::string freqDir = roots.sys + "/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq";
+        std::filesystem::create_directories(freqDir);
+        std::ofstream(freqDir + "/scaling_cur_freq") << (2900 + cpu) * 1000 << "\n";
+        std::ofstream(freqDir + "/cpuinfo_max_freq") << "4500000\n";
+    }
+    std::filesystem::create_directories(roots.sys + "/devices/system/cpu/cpufreq");
+    // Two NUMA nodes of cpus / 2 each, SMT pairs as in cpuinfo below.
+    for (int cpu = 0; cpu < cpus; ++cpu) {
+        std::string topologyDir = roots.sys + "/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology";
+        std::filesystem::create_directories(topologyDir);
+        std::ofstream(topologyDir + "/physical_package_id") << "0\n";
+        std::ofstream(topologyDir + "/core_id") << cpu / 2 << "\n";
+    }
+    std::ofstream(roots.sys + "/devices/system/cpu/online") << "0-" << cpus - 1 << "\n";
+    for (int node = 0; node < 2; ++node) {
+        std::string nodeDir = roots.sys + "/devices/system/node/node" + std::to_string(node);
+        std::filesystem::create_directories(nodeDir);
+        std::ofstream(nodeDir + "/cpulist") << node * cpus / 2 << "-" << (node + 1) * cpus / 2 - 1 << "\n";
+    }
+
+    {
+        std::ofstream cpuinfo(roots.proc + "/cpuinfo");
+        for (int cpu = 0; cpu < cpus; ++cpu) {
+            cpuinfo << "processor\t: " << cpu << "\n"
+                    << "vendor_id\t: GenuineIntel\n"
+                    << "model name\t: Fixture CPU @ 3.00GHz\n"
+                    << "cpu MHz\t\t: " << 2900 + cpu << ".000\n"
+                    << "cache size\t: 32768 KB\n"
+                    << "physical id\t: 0\n"
+                    << "core id\t\t: " << cpu / 2 << "\n"
+                    << "cpu cores\t: " << cpus / 2 << "\n\n";
+        }
+    }
+
+    std::ofstream(roots.proc + "/meminfo")
+        << "MemTotal:       32768000 kB\n"
+        << "MemFree:         8192000 kB\n"
+        << "MemAvailable:   16384000 kB\n"
+        << "Buffers:          512000 kB\n"
+        << "Cached:          6144000 kB\n"
+        << "SwapCached:            0 kB\n"
+        << "SwapTotal:       8192000 kB\n"
+        << "SwapFree:        8000000 kB\n"
+        << "Zswap:                 0 kB\n"
+        << "Zswapped:              0 kB\n"
+        << "Dirty:              1024 kB\n"
+        << "Writeback:             0 kB\n"
+        << "AnonPages:       4096000 kB\n"
+        << "Mapped:           768000 kB\n"
+        << "Shmem:            256000 kB\n"
+        << "KReclaimable:     640000 kB\n"
+        << "Slab:             900000 kB\n"
+        << "SReclaimable:     640000 kB\n"
+        << "SUnreclaim:       260000 kB\n"
+        << "KernelStack:       24000 kB\n"
+        << "PageTables:        60000 kB\n"
+        << "SecPageTables:         0 kB\n"
+        << "NFS_Unstable:          0 kB\n"
+        << "Bounce:                0 kB\n"
+        << "WritebackTmp:          0 kB\n"
+        << "CommitLimit:    24576000 kB\n"
+        << "Committed_AS:   12000000 kB\n"
+        << "VmallocTotal:   34359738367 kB\n"
+        << "VmallocUsed:       90000 kB\n"
+        << "VmallocChunk:          0 kB\n"
+        << "Percpu:            12000 kB\n"
+        << "HardwareCorrupted:     0 kB\n"
+        << "AnonHugePages:    512000 kB\n"
+        << "ShmemHugePages:        0 kB\n"
+        << "ShmemPmdMapped:        0 kB\n"
+        << "FileHugePages:         0 kB\n"
+        << "FilePmdMapped:         0 kB\n"
+        << "HugePages_Total:      64\n"
+        << "HugePages_Free:       48\n"
+        << "HugePages_Rsvd:        4\n"
+        << "HugePages_Surp:        0\n"
+        << "Hugepagesize:       2048 kB\n"
+        << "Hugetlb:          131072 kB\n"
+        << "DirectMap4k:      400000 kB\n"
+        << "DirectMap2M:    20000000 kB\n"
+        << "DirectMap1G:    13000000 kB\n";
+
+    std::ofstream(roots.proc + "/uptime") << "123456.78 987654.32\n";
+    std::ofstream(roots.proc + "/loadavg") << "1.25 0.75 0.50 3/" << processes << " 4242\n";
+    std::ofstream(roots.proc + "/version") << "Linux version 6.1.0-fixture (gcc) #1 SMP\n";
+    std::ofstream(roots.proc + "/swaps")
+        << "Filename\t\t\t\tType\t\tSize\t\tUsed\t\tPriority\n"
+        << "/dev/sda2                               partition\t8192000\t\t192000\t\t-2\n";
+    std::ofstream(roots.proc + "/mounts")
+        << "/dev/sda1 / ext4 rw,relatime 0 0\n"
+        << "proc /proc proc rw,nosuid,nodev,noexec,relatime 0 0\n"
+        << "tmpfs /run tmpfs rw,nosuid,nodev 0 0\n"
+        << "/dev/sdb1 /data ext4 rw,relatime 0 0\n";
+    std::ofstream(roots.proc + "/diskstats")
+        << "   8       0 sda 1000 10 200000 500 2000 20 400000 900 0 1200 1400 0 0 0 0 0 0\n"
+        << "   8       1 sda1 900 9 180000 450 1900 19 380000 850 0 1100 1300 0 0 0 0 0 0\n"
+        << "   8      16 sdb 300 3 60000 150 600 6 120000 300 0 400 450 0 0 0 0 0 0\n"
+        << "   8      17 sdb1 290 3 58000 140 590 6 118000 290 0 390 430 0 0 0 0 0 0\n";
+    std::ofstream(roots.proc + "/net/route")
+        << "Iface\tDestination\tGateway \tFlags\tRefCnt\tUse\tMetric\tMask\t\tMTU\tWindow\tIRTT\n"
+        << "eth0\t00000000\t0102A8C0\t0003\t0\t0\t100\t00000000\t0\t0\t0\n";
+    std::ofstream(roots.proc + "/net/dev")
+        << "Inter-|   Receive                                                |  Transmit\n"
+        << " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+        << "    lo:  123456     100    0    0    0     0          0         0   123456     100    0    0    0     0       0          0\n"
+        << "  eth0: 987654321 654321    0    0    0     0          0         0 123456789 321654    0    0    0     0       0          0\n";
+
+    std::ofstream passwd(roots.etc + "/passwd");
+    passwd << "root:x:0:0:root:/root:/bin/bash\n";
+    for (int uid = 1; uid < 50; ++uid) {
+        passwd << "user" << uid << ":x:" << uid << ":" << uid << "::/home/user" << uid << ":/bin/sh\n";
+    }
+}
+
+#endif // PROC_FIXTURE_H
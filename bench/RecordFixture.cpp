@@ -0,0 +1,54 @@
+// Records a fixture tree from MakeProcFixture as a replayable sampler stream,
+// for driving the UI under a reproducible load:
+//
+//   RecordFixture DIR FILE [ticks]
+//   GUITaskManager --replay FILE --replay-speed max
+//
+// The fixture does not change between ticks, so the snapshots are spaced one
+// second apart by hand rather than by sampling in real time.
+
+#include "headers/SystemSampler.h"
+#include "headers/SnapshotRecording.h"
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s DIR FILE [ticks]\n", argv[0]);
+        return 1;
+    }
+
+    std::string dir = argv[1];
+    int ticks = argc > 3 ? std::atoi(argv[3]) : 60;
+
+    SystemRoots roots;
+    roots.proc = dir + "/proc";
+    roots.sys = dir + "/sys";
+    roots.etc = dir + "/etc";
+
+    std::vector<std::string> mountPaths = {"/"};
+    SystemSampler sampler(mountPaths, 1, roots);
+    SnapshotWriter writer;
+    if (!writer.open(argv[2], mountPaths)) {
+        std::fprintf(stderr, "%s\n", writer.error().c_str());
+        return 1;
+    }
+
+    SamplePlan plan;
+    plan.processFields = SampleOwner | SampleIo;
+    double start = 0.0;
+    size_t processes = 0;
+    for (int i = 0; i < ticks; ++i) {
+        StatsSnapshot snapshot = *sampler.collect(plan);
+        if (i == 0) start = snapshot.timestamp;
+        snapshot.timestamp = start + i;
+        snapshot.intervalSec = 1.0;
+        processes = snapshot.processes.size();
+        if (!writer.write(snapshot)) {
+            std::fprintf(stderr, "%s\n", writer.error().c_str());
+            return 1;
+        }
+    }
+    std::printf("Recorded %d ticks of %zu processes to %s\n", ticks, processes, argv[2]);
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Measures ProcessSampler::sample() with 1..N workers against a synthetic
+// /proc tree (or a real one with --proc).
+//
+//   SamplerScalingBench [--processes N] [--max-workers N] [--iterations N] [--proc DIR]
+
+#include "headers/ProcessSampler.h"
+#include "ProcFixture.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+int main(int argc, char* argv[]) {
+    int processes = 10000;
+    unsigned maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+    int iterations = 20;
+    std::string procRoot;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--processes") == 0) processes = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--max-workers") == 0) maxWorkers = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--iterations") == 0) iterations = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--proc") == 0) procRoot = argv[i + 1];
+    }
+
+    bool ownFixture = procRoot.empty();
+    if (ownFixture) {
+        char tmpl[] = "/tmp/procfixture-XXXXXX";
+        if (!mkdtemp(tmpl)) {
+            std::perror("mkdtemp");
+            return 1;
+        }
+        procRoot = tmpl;
+        std::printf("Writing %d synthetic processes to %s\n", processes, procRoot.c_str());
+        writeProcFixture(procRoot, processes);
+    }
+
+    std::printf("%8s %12s %10s %8s\n", "workers", "ms/pass", "records", "speedup");
+
+    double baseline = 0.0;
+    for (unsigned workers = 1; workers <= maxWorkers; workers *= 2) {
+        SystemRoots roots;
+        roots.proc = procRoot;
+        ProcessSampler sampler(roots, workers);
+        std::vector<ProcessSample> samples;
+        unsigned fields = SampleOwner | SampleIo;
+
+        sampler.sample(fields, samples); // warm the descriptor cache
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            sampler.sample(fields, samples);
+        }
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count() / iterations;
+
+        if (workers == 1) baseline = ms;
+        std::printf("%8u %12.2f %10zu %7.2fx\n", workers, ms, samples.size(), baseline / ms);
+    }
+
+    if (ownFixture) {
+        std::filesystem::remove_all(procRoot);
+    }
+    return 0;
+}
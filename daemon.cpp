@@ -0,0 +1,8 @@
+#include "headers/CollectorDaemon.h"
+#include "headers/ProcessSampler.h"
+
+int main(int argc, char* argv[])
+{
+    ProcessSampler::raiseFdLimit();
+    return collectorDaemonMain(argc, argv);
+}
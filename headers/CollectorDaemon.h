@@ -0,0 +1,17 @@
+#ifndef COLLECTOR_DAEMON_H
+
+#define COLLECTOR_DAEMON_H
+
+// Runs the sampling engine headless, serving snapshots to GUI viewers over
+// a Unix domain socket until SIGINT or SIGTERM:
+//
+//   GUITaskManagerDaemon [--socket PATH] [--interval MS] [--workers N]
+//                        [--metrics-port PORT [--metrics-address ADDR]
+//                         [--metrics-top N]]
+//   GUITaskManager --headless [same options]
+//
+// /proc is only walked while a viewer is attached, or on every tick when
+// --metrics-port serves the ticks to Prometheus as well.
+int collectorDaemonMain(int argc, char* argv[]);
+
+#endif // COLLECTOR_DAEMON_H
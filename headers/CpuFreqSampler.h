@@ -0,0 +1,47 @@
+#ifndef CPU_FREQ_SAMPLER_H
+
+#define CPU_FREQ_SAMPLER_H
+
+#include <vector>
+#include "processParser.h"
+
+// Clock speed of every logical processor at one instant, in MHz.
+struct CpuFreqSample {
+    std::vector<double> perCpuMhz; // indexed by CPU number; 0 when offline or unknown
+    double minMhz = 0.0;
+    double avgMhz = 0.0;
+    double maxMhz = 0.0;
+    double ratedMaxMhz = 0.0;      // highest cpuinfo_max_freq; 0 when unknown
+};
+
+// Reads each CPU's cpufreq/scaling_cur_freq through a descriptor opened once,
+// so a tick costs one pread per CPU instead of the kernel generating all of
+// /proc/cpuinfo. Machines without cpufreq (most VMs) fall back to the
+// "cpu MHz" lines of /proc/cpuinfo; those hardly ever change, so the file
+// is read at construction and then only once a minute of samples.
+class CpuFreqSampler {
+public:
+    explicit CpuFreqSampler(const SystemRoots& roots = SystemRoots());
+    ~CpuFreqSampler();
+
+    CpuFreqSampler(const CpuFreqSampler&) = delete;
+    CpuFreqSampler& operator=(const CpuFreqSampler&) = delete;
+
+    // Does not allocate once perCpuMhz has grown to the CPU count.
+    void sample(CpuFreqSample& out);
+
+    // True when cpufreq is present and /proc/cpuinfo is not read.
+    bool usesCpufreq() const { return m_available; }
+
+private:
+    void readCpuinfo();
+
+    std::string m_cpuinfoPath;
+    std::vector<int> m_fds;   // indexed by CPU number; -1 when not readable
+    double m_ratedMaxMhz = 0.0;
+    bool m_available = false;
+    std::vector<double> m_cpuinfoMhz;   // last read of the fallback
+    unsigned m_samplesSinceCpuinfo = 0;
+};
+
+#endif // CPU_FREQ_SAMPLER_H
@@ -0,0 +1,41 @@
+#ifndef CPU_GRID_WIDGET_H
+
+#define CPU_GRID_WIDGET_H
+
+#include <QWidget>
+#include <vector>
+
+// One small utilisation graph per logical processor, painted directly so a
+// 256-thread machine costs one widget instead of 256 plots. History is a
+// fixed ring of samples per CPU stored in a single contiguous buffer.
+class CpuGridWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CpuGridWidget(QWidget *parent = nullptr);
+
+    // Appends one sample per CPU (percent) and schedules a repaint.
+    void addSample(const std::vector<double>& perCpuUsagePercent);
+    void clear();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    static constexpr int kHistory = 60;
+    static constexpr int kCellWidth = 96;
+    static constexpr int kCellHeight = 48;
+    static constexpr int kSpacing = 4;
+
+    int columns() const;
+    void updateMinimumHeight();
+
+    int m_cpuCount = 0;
+    int m_head = 0;        // slot the next sample goes to
+    int m_filled = 0;      // samples held, up to kHistory
+    std::vector<float> m_history; // m_cpuCount * kHistory, one ring per CPU
+};
+
+#endif // CPU_GRID_WIDGET_H
@@ -0,0 +1,40 @@
+#ifndef CPU_HEATMAP_WIDGET_H
+
+#define CPU_HEATMAP_WIDGET_H
+
+#include <QWidget>
+#include <vector>
+
+// A wrapping row of small squares, one per logical processor, coloured from
+// cool to hot by how close that CPU's clock is to the rated maximum.
+class CpuHeatmapWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CpuHeatmapWidget(QWidget *parent = nullptr);
+
+    // scaleMhz is the clock drawn at full heat; 0 uses the highest seen.
+    void setFrequencies(const std::vector<double>& perCpuMhz, double scaleMhz);
+
+    bool hasHeightForWidth() const override { return true; }
+    int heightForWidth(int width) const override;
+    QSize sizeHint() const override;
+
+protected:
+    bool event(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    static constexpr int kCell = 14;
+    static constexpr int kSpacing = 2;
+
+    int columns(int width) const;
+    int cpuAt(const QPoint& pos) const;
+
+    std::vector<double> m_mhz;
+    double m_scaleMhz = 0.0;
+    double m_seenMaxMhz = 0.0;
+};
+
+#endif // CPU_HEATMAP_WIDGET_H
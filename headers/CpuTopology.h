@@ -0,0 +1,40 @@
+#ifndef CPU_TOPOLOGY_H
+
+#define CPU_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+#include "processParser.h"
+
+// How the logical processors are laid out: which socket, physical core and
+// NUMA node each one belongs to. Read once from /sys/devices/system/cpu and
+// /sys/devices/system/node; none of it changes without a CPU hotplug.
+struct CpuTopology {
+    struct Cpu {
+        bool online = false;
+        int socket = -1;    // index into socketIds
+        int core = -1;      // dense across sockets; SMT siblings share it
+        int node = -1;      // NUMA node number
+    };
+
+    std::vector<Cpu> cpus;          // indexed by CPU number
+    std::vector<int> socketIds;     // physical_package_id of each socket
+    int coreCount = 0;
+    int nodeCount = 0;              // 1 on machines without NUMA
+
+    static CpuTopology read(const SystemRoots& roots = SystemRoots());
+
+    int socketCount() const { return static_cast<int>(socketIds.size()); }
+    int onlineCount() const;
+    // -1 when the CPU number is unknown.
+    int nodeOf(int cpu) const;
+    // Logical processors that share a physical core with cpu, itself included.
+    std::vector<int> siblingsOf(int cpu) const;
+
+    // Average of a per-CPU value (indexed by CPU number) over each socket or
+    // node. Offline CPUs are left out. out is resized and overwritten.
+    void averageBySocket(const std::vector<double>& perCpu, std::vector<double>& out) const;
+    void averageByNode(const std::vector<double>& perCpu, std::vector<double>& out) const;
+};
+
+#endif // CPU_TOPOLOGY_H
@@ -0,0 +1,53 @@
+#ifndef GPU_COLLECTOR_H
+
+#define GPU_COLLECTOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+#include <memory>
+#include "GpuSampler.h"
+
+// Runs a GpuSampler on its own timer and thread, so a slow backend (rocm-smi)
+// never holds up the UI or the StatsCollector tick. Results are published the
+// same way StatsCollector publishes snapshots: an atomic shared_ptr swap and
+// a sampleReady() signal that fires at most once until takeLatest().
+//
+// Move the collector to a QThread and connect QThread::started to start().
+// It samples nothing until setActive(true).
+class GpuCollector : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GpuCollector(int intervalMs = 1000);
+    ~GpuCollector();
+
+    // Safe to call from any thread.
+    // One sample per card, in GpuSampler::enumerate() order.
+    std::shared_ptr<const std::vector<GpuSample>> takeLatest();
+    // Turning sampling on takes a sample right away.
+    void setActive(bool active);
+    void setIntervalMs(int intervalMs);
+
+public slots:
+    void start();
+
+signals:
+    void sampleReady();
+
+private slots:
+    void sampleNow();
+    void applySettings();
+
+private:
+    std::unique_ptr<GpuSampler> m_sampler;
+    QTimer* m_timer = nullptr;
+
+    std::shared_ptr<const std::vector<GpuSample>> m_latest;
+    std::atomic<int> m_intervalMs;
+    std::atomic<bool> m_active{false};
+    std::atomic<bool> m_pending{false};
+};
+
+#endif // GPU_COLLECTOR_H
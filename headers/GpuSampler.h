@@ -0,0 +1,86 @@
+#ifndef GPU_SAMPLER_H
+
+#define GPU_SAMPLER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "processParser.h"
+
+// Metrics a GpuSample may carry. A backend sets the bit for every value it
+// actually read; the rest stay zero and are shown as N/A.
+enum GpuMetric : unsigned {
+    GpuUsage       = 1u << 0,
+    GpuVramTotal   = 1u << 1,
+    GpuVramUsed    = 1u << 2,
+    GpuTemperature = 1u << 3,
+    GpuFan         = 1u << 4,
+    GpuPower       = 1u << 5,
+    GpuClock       = 1u << 6,
+};
+
+// A DRM card driven by one of the drivers GpuSampler can read.
+struct GpuDevice {
+    std::string card;       // "card0"; empty for a card only rocm-smi sees
+    std::string driver;     // amdgpu, i915, xe or nouveau
+    std::string vendor;
+    std::string name;
+};
+
+// One reading of one GPU, in fixed units. Formatting is left to the view.
+struct GpuSample {
+    std::string card;           // matches GpuDevice::card
+    std::string deviceName;     // empty when no GPU was found
+    std::string vendor;
+    unsigned valid = 0;         // GpuMetric bits
+
+    double busyPercent = 0.0;
+    uint64_t vramTotalBytes = 0;
+    uint64_t vramUsedBytes = 0;
+    double temperatureC = 0.0;
+    double fanRpm = 0.0;
+    double powerWatts = 0.0;
+    double clockMhz = 0.0;
+
+    bool has(GpuMetric metric) const { return (valid & metric) != 0; }
+};
+
+// One way of reading GPUs. probe() runs once; sample() runs on every GPU tick
+// and should only re-read what probe() already located.
+class GpuBackend {
+public:
+    virtual ~GpuBackend() = default;
+
+    virtual const char* name() const = 0;
+    virtual bool probe() = 0;
+    // Appends one sample per card found by probe(), in card order.
+    virtual void sample(std::vector<GpuSample>& out) = 0;
+};
+
+// Reads every GPU through the first backend that probes successfully: the
+// drivers' own sysfs and hwmon files, then rocm-smi as an optional fallback.
+class GpuSampler {
+public:
+    explicit GpuSampler(const SystemRoots& roots = SystemRoots(), bool allowRocmSmi = true);
+    ~GpuSampler();
+
+    GpuSampler(const GpuSampler&) = delete;
+    GpuSampler& operator=(const GpuSampler&) = delete;
+
+    // Cards the sysfs backend will report, in the order sample() returns
+    // them. Cheap enough to call from the UI while it builds its pages.
+    static std::vector<GpuDevice> enumerate(const SystemRoots& roots = SystemRoots());
+
+    // Samples all cards in one pass. The vector is cleared but keeps its
+    // capacity.
+    void sample(std::vector<GpuSample>& out);
+
+    // "none" when no backend found a GPU.
+    const char* backendName() const;
+
+private:
+    std::unique_ptr<GpuBackend> m_backend;
+};
+
+#endif // GPU_SAMPLER_H
@@ -0,0 +1,42 @@
+#ifndef MEMORY_COMPOSITION_BAR_H
+
+#define MEMORY_COMPOSITION_BAR_H
+
+#include <QColor>
+#include <QString>
+#include <QVector>
+#include <QWidget>
+#include "processParser.h"
+
+// A horizontal bar split into what physical memory is being used for: in
+// use, huge pages, shared, modified, cached and free. Hovering a segment
+// shows its size.
+class MemoryCompositionBar : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MemoryCompositionBar(QWidget *parent = nullptr);
+
+    void setMemInfo(const MemInfo &info);
+
+    QSize sizeHint() const override { return QSize(400, 28); }
+
+protected:
+    bool event(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    struct Segment {
+        QString name;
+        QColor color;
+        long kb = 0;
+    };
+
+    int segmentAt(int x) const;
+
+    QVector<Segment> m_segments;
+    long m_totalKb = 0;
+};
+
+#endif // MEMORY_COMPOSITION_BAR_H
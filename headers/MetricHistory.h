@@ -0,0 +1,81 @@
+#ifndef METRIC_HISTORY_H
+
+#define METRIC_HISTORY_H
+
+#include <cmath>
+#include "RingSeries.h"
+
+// Resolutions a MetricHistory keeps, finest first.
+enum HistoryTier {
+    TierSeconds,        // every sample, 10 minutes
+    TierTenSeconds,     // 10 s buckets, 6 hours
+    TierMinutes,        // 1 min buckets, 7 days
+    TierCount
+};
+
+// One bucket of a tier. In TierSeconds min, avg and max are the sample.
+// A bucket with no finite samples is all NaN and drawn as a gap.
+struct HistoryPoint {
+    double time = 0.0;  // bucket start, seconds since the epoch
+    float min = 0.0f;
+    float avg = 0.0f;
+    float max = 0.0f;
+};
+
+// A metric's history at three resolutions, in fixed memory (about 300 KB).
+// Both coarse tiers are built from the raw samples rather than from each
+// other, and keep each bucket's min and max, so a one-second spike is still
+// visible a week later.
+class MetricHistory {
+public:
+    static double resolution(HistoryTier tier);
+    static double span(HistoryTier tier);
+    // Finest tier that reaches spanSeconds back.
+    static HistoryTier tierFor(double spanSeconds);
+
+    // Samples must arrive in time order. NaN records a gap.
+    void add(double time, double value);
+
+    // Changes whenever the tier gains a point. A bucket is only added once
+    // it closes, so the coarse tiers trail the newest sample by up to one
+    // bucket.
+    unsigned long revision(HistoryTier tier) const { return m_revisions[tier]; }
+
+    // Calls f(const HistoryPoint&) for the tier's points at or after since,
+    // oldest first.
+    template <typename F>
+    void forEach(HistoryTier tier, double since, F f) const {
+        auto visit = [&](const HistoryPoint& point) {
+            if (point.time >= since) f(point);
+        };
+        switch (tier) {
+            case TierSeconds: m_seconds.forEach(visit); break;
+            case TierTenSeconds: m_tenSeconds.forEach(visit); break;
+            case TierMinutes: m_minutes.forEach(visit); break;
+            default: break;
+        }
+    }
+
+private:
+    // The coarse tier bucket still being filled.
+    struct OpenBucket {
+        bool open = false;
+        double start = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        double sum = 0.0;
+        int count = 0;      // finite samples
+    };
+
+    void accumulate(HistoryTier tier, OpenBucket& bucket, double time, double value);
+    void close(HistoryTier tier, const OpenBucket& bucket);
+
+    RingSeries<HistoryPoint, 600> m_seconds;
+    RingSeries<HistoryPoint, 2160> m_tenSeconds;
+    RingSeries<HistoryPoint, 10080> m_minutes;
+    OpenBucket m_tenSecondBucket;
+    OpenBucket m_minuteBucket;
+    unsigned long m_revisions[TierCount] = {};
+};
+
+#endif // METRIC_HISTORY_H
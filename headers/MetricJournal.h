@@ -0,0 +1,139 @@
+#ifndef METRIC_JOURNAL_H
+
+#define METRIC_JOURNAL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "StatsSnapshot.h"
+
+// Disks a journal keeps columns for, in the collector's mount path order.
+static constexpr unsigned kJournalDisks = 8;
+
+// Per-tick values, one column each. Rates are per second.
+enum JournalColumn : unsigned {
+    JournalCpuPercent,
+    JournalMemPercent,
+    JournalNetSendBits,
+    JournalNetRecvBits,
+    JournalDiskFirst,   // then active %, read bytes, write bytes for each disk
+    JournalColumnCount = JournalDiskFirst + 3 * kJournalDisks
+};
+
+inline JournalColumn journalDiskColumn(unsigned disk, unsigned field) {
+    return static_cast<JournalColumn>(JournalDiskFirst + 3 * disk + field);
+}
+
+// Processes a tick keeps: the top kJournalTopProcesses by CPU, then the top
+// kJournalTopProcesses by resident memory that are not already among them.
+static constexpr unsigned kJournalTopProcesses = 5;
+static constexpr unsigned kJournalProcesses = 2 * kJournalTopProcesses;
+
+// One row of a tick's process section. pid 0 marks an unused row, and a
+// tick sampled without MetricProcesses has only those.
+struct JournalProcess {
+    int32_t pid;
+    float cpuPercent;
+    int64_t memoryKb;
+    char name[16];      // comm, NUL-padded
+    char owner[32];     // empty unless the tick had owners
+};
+
+struct JournalHeader;
+
+// Append-only history of StatsSnapshots in a memory-mapped file of fixed
+// size, laid out as columns of slotCount ticks used as a ring. Reopening
+// it maps the columns straight back, so the last hours are readable at once
+// without parsing anything. Ticks that carried the process list also keep
+// its top rows, so a past spike can be put down to the processes behind it.
+//
+// append() writes a tick into the mapping and only then advances the
+// header, so a crash of the process costs at most the tick being written.
+// A background thread msyncs after every tick, but msync does not order
+// pages, so after a power loss a slot can be on disk only in part; each
+// slot carries a checksum of its values, and a slot that fails it is
+// skipped on replay. One writer per file, enforced with flock. The
+// collector appends from its thread, and the reader must be done before
+// the first append.
+class MetricJournal {
+public:
+    MetricJournal() = default;
+    ~MetricJournal();
+
+    MetricJournal(const MetricJournal&) = delete;
+    MetricJournal& operator=(const MetricJournal&) = delete;
+
+    // Opens or creates the file. An existing file with another geometry or
+    // a bad header is started over. Returns false with error() set.
+    bool open(const std::string& path, uint32_t slotCount);
+    void close();
+    bool isOpen() const { return m_map != nullptr; }
+    const std::string& error() const { return m_error; }
+
+    // Records one tick. diskNames labels the disk columns and is only
+    // rewritten when it changes; a disk column that changes hands is
+    // blanked in every stored tick first, so the old mount's history never
+    // shows up under the new name.
+    void append(const StatsSnapshot& snapshot, const std::vector<std::string>& diskNames);
+
+    uint32_t capacity() const { return m_slotCount; }
+    // Ticks held, at most capacity().
+    size_t size() const;
+
+    // Calls f(size_t tick) for each stored tick at or after since, oldest
+    // first; tick is the index to pass to the accessors below.
+    template <typename F>
+    void forEachTick(double since, F f) const {
+        uint64_t end = sequence();
+        uint64_t begin = end - size();
+        for (uint64_t seq = begin; seq < end; ++seq) {
+            size_t slot = static_cast<size_t>(seq % m_slotCount);
+            // A slot that never reached the disk in full is skipped.
+            if (m_slotSequence[slot] != seq + 1 || m_time[slot] < since) continue;
+            if (m_slotChecksum[slot] != checksum(slot, seq)) continue;
+            f(slot);
+        }
+    }
+
+    double time(size_t tick) const { return m_time[tick]; }
+    float value(JournalColumn column, size_t tick) const { return m_columns[column * m_slotCount + tick]; }
+    // kJournalProcesses rows, CPU picks first.
+    const JournalProcess* processes(size_t tick) const { return m_processes + tick * kJournalProcesses; }
+    // Mount path of a disk column, empty if unused.
+    std::string diskName(unsigned disk) const;
+
+private:
+    uint64_t sequence() const;
+    uint32_t checksum(size_t slot, uint64_t seq) const;
+    void clearDisk(unsigned disk);
+    void storeProcesses(const StatsSnapshot& snapshot, JournalProcess* rows);
+    void flushLoop();
+
+    std::string m_error;
+    int m_fd = -1;
+    void* m_map = nullptr;
+    size_t m_mapSize = 0;
+    uint32_t m_slotCount = 0;
+
+    // Views into the mapping.
+    JournalHeader* m_header = nullptr;
+    double* m_time = nullptr;
+    uint64_t* m_slotSequence = nullptr;  // sequence + 1 of the tick in the slot, 0 if none
+    uint32_t* m_slotChecksum = nullptr;  // checksum() of the tick in the slot
+    float* m_columns = nullptr;          // JournalColumnCount columns of m_slotCount
+    JournalProcess* m_processes = nullptr;  // kJournalProcesses rows per slot
+
+    std::vector<size_t> m_order;        // reused by storeProcesses()
+
+    std::thread m_flusher;
+    std::mutex m_flushMutex;
+    std::condition_variable m_flushWake;
+    bool m_flushPending = false;
+    bool m_stopping = false;
+};
+
+#endif // METRIC_JOURNAL_H
@@ -0,0 +1,77 @@
+#ifndef METRICS_EXPORTER_H
+
+#define METRICS_EXPORTER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "GpuSampler.h"
+#include "StatsSnapshot.h"
+
+// Serves the latest tick to Prometheus as OpenMetrics text on
+// http://ADDRESS:PORT/metrics. publish() renders each tick once, straight
+// into a complete HTTP response; a scrape only copies those bytes out, so
+// it never reads /proc and a second scraper costs nothing extra.
+//
+// Processes are limited to the top N by CPU plus the top N by memory, which
+// keeps the series count bounded on a machine with thousands of them.
+//
+// The listener runs on its own thread around poll().
+class MetricsExporter {
+public:
+    explicit MetricsExporter(size_t topProcesses = 20);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Binds a numeric IPv4 or IPv6 address; port 0 picks a free one.
+    // Returns false with error() set.
+    bool listen(const std::string& address, uint16_t port);
+    void close();
+    const std::string& error() const { return m_error; }
+    uint16_t port() const { return m_port; }
+
+    // Makes this tick what scrapes see. Call from the sampling thread.
+    void publish(const StatsSnapshot& snapshot,
+                 const std::vector<InterfaceCounters>& interfaces,
+                 const std::vector<GpuSample>& gpus);
+
+    // The body publish() serves, appended to out.
+    void render(const StatsSnapshot& snapshot,
+                const std::vector<InterfaceCounters>& interfaces,
+                const std::vector<GpuSample>& gpus,
+                std::string& out);
+
+private:
+    struct Response {
+        std::string bytes;      // status line, headers and body
+        size_t headerSize = 0;  // all a HEAD request gets
+    };
+    struct Client;
+
+    static std::shared_ptr<const Response> makeResponse(const char* status, const char* contentType,
+                                                        const std::string& body);
+    void run();
+    // Reads more of the request; false once the client should be closed.
+    bool receive(Client& client);
+    bool send(Client& client);
+
+    size_t m_topProcesses;
+    int m_listenFd = -1;
+    int m_wakeFds[2] = {-1, -1};    // written by close() to stop run()
+    uint16_t m_port = 0;
+    std::string m_error;
+    std::thread m_thread;
+    std::shared_ptr<const Response> m_response;
+
+    // Reused by render(), which only runs on the sampling thread.
+    std::string m_body;
+    std::vector<std::string> m_labels;
+    std::vector<size_t> m_order;
+    std::vector<size_t> m_topRows;
+};
+
+#endif // METRICS_EXPORTER_H
@@ -0,0 +1,110 @@
+#ifndef PROCESS_SAMPLER_H
+
+#define PROCESS_SAMPLER_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sys/types.h>
+#include "processParser.h"
+#include "UidCache.h"
+#include "WorkStealingPool.h"
+
+// Optional per-process files. /proc/PID/stat and /proc/PID/statm are always
+// read; everything else is only opened when a visible column needs it.
+enum SampleField : unsigned {
+    SampleCore  = 0,
+    SampleOwner = 1u << 0,  // /proc/PID/status (Uid)
+    SampleIo    = 1u << 1,  // /proc/PID/io
+};
+
+struct ProcessSample {
+    int pid = 0;
+    int ppid = 0;
+    char state = '?';
+    char name[16] = {};     // comm, the kernel caps it at 15 characters
+    long activeJiffies = 0; // utime + stime + cutime + cstime
+    unsigned long long startTime = 0;
+    long threads = 0;
+    int lastCpu = -1;       // CPU it last ran on
+    long memoryKb = 0;      // resident set size from statm
+    uid_t uid = 0;
+    bool hasUid = false;
+    OwnerHandle owner;      // set with SampleOwner
+    bool hasIo = false;
+    IoStats io;
+};
+
+class ProcessSampler {
+public:
+    explicit ProcessSampler(const SystemRoots& roots = SystemRoots(), unsigned workers = defaultWorkerCount());
+    ~ProcessSampler();
+
+    ProcessSampler(const ProcessSampler&) = delete;
+    ProcessSampler& operator=(const ProcessSampler&) = delete;
+
+    // Walks /proc once and fills one record per live PID, sorted by PID. The
+    // output vector is cleared but keeps its capacity, so steady-state ticks
+    // do not allocate.
+    void sample(unsigned fields, std::vector<ProcessSample>& out);
+
+    bool sampleProcess(int pid, unsigned fields, ProcessSample& out);
+
+    // With more than one worker the PID list is split into shards that a
+    // work-stealing pool samples in parallel. Changing it drops the fd cache.
+    void setWorkerCount(unsigned workers);
+    unsigned workerCount() const { return m_pool ? m_pool->workerCount() : 1; }
+    static unsigned defaultWorkerCount();
+    // Lifts the soft RLIMIT_NOFILE towards 65536, within the hard limit, so
+    // the fd cache can cover more processes. The limit is process-wide, so
+    // this is left to main() to call before anything else opens files; the
+    // sampler itself only sizes its cache from whatever limit is in force.
+    static void raiseFdLimit();
+
+    static const char* stateName(char state);
+
+    size_t cachedFdCount() const { return m_openFds.load(); }
+
+private:
+    enum ProcFile { FileStat, FileStatm, FileStatus, FileIo, FileCount };
+
+    // Descriptors for one process, kept open across ticks and re-read with
+    // pread at offset 0. startTime tells a live process from a recycled PID.
+    struct CachedProcess {
+        unsigned long long startTime = 0;
+        unsigned long generation = 0;
+        int fds[FileCount] = {-1, -1, -1, -1};
+    };
+
+    // PIDs are assigned to shards by pid % shard count, so a process always
+    // lands in the same shard and keeps its cached descriptors, whichever
+    // worker ends up sampling it. Each shard is touched by one worker at a time.
+    struct Shard {
+        std::unordered_map<int, CachedProcess> cache;
+        std::vector<int> pids;
+        std::vector<ProcessSample> out;
+    };
+
+    Shard& shardFor(int pid) { return m_shards[static_cast<size_t>(pid) % m_shards.size()]; }
+    void sampleShard(Shard& shard, unsigned fields);
+    bool sampleInto(Shard& shard, int pid, unsigned fields, ProcessSample& out);
+    ssize_t readProcFile(int pid, ProcFile file, CachedProcess* cached, char* buf, size_t cap);
+    void closeCached(CachedProcess& cached);
+    void evict(Shard& shard, int pid);
+    void evictStale(Shard& shard);
+    void clearCache();
+
+    std::string m_procRoot;
+    long m_pageKb;
+    UidCache m_uidCache;
+    std::unique_ptr<WorkStealingPool> m_pool;
+    std::vector<Shard> m_shards;
+    unsigned long m_generation = 0;
+    std::atomic<size_t> m_openFds{0};
+    std::atomic<size_t> m_fdBudget{0};
+    std::atomic<unsigned> m_fdBackoffPasses{0};
+};
+
+#endif // PROCESS_SAMPLER_H
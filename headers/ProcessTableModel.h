@@ -0,0 +1,62 @@
+#ifndef PROCESS_TABLE_MODEL_H
+
+#define PROCESS_TABLE_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QString>
+#include <vector>
+#include "StatsSnapshot.h"
+
+// Process list backed by the collector's snapshots. Rows are kept ordered by
+// PID and updated in place: a new snapshot only produces dataChanged for the
+// cells whose value moved, plus row inserts/removes for processes that
+// started or exited. Views sort through a QSortFilterProxyModel.
+class ProcessTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        ColName,
+        ColPid,
+        ColCpu,
+        ColMemory,
+        ColOwner,
+        ColStatus,
+        ColNode,
+        ColumnCount
+    };
+
+    // Raw numeric value of a cell, for sorting.
+    static const int SortRole = Qt::UserRole;
+
+    explicit ProcessTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Processes in the snapshot must be sorted by PID, as SystemSampler emits them.
+    void updateFromSnapshot(const StatsSnapshot &snapshot);
+
+    int pidAt(int row) const;
+
+private:
+    struct Row {
+        int pid = 0;
+        char rawName[16] = {};
+        QString name;
+        QString owner;
+        char state = '?';
+        double cpuPercent = 0.0;
+        long memoryKb = 0;
+        int numaNode = -1;
+    };
+
+    void assign(Row &row, const ProcessRow &process, const QString &owner) const;
+
+    std::vector<Row> m_rows;
+};
+
+#endif // PROCESS_TABLE_MODEL_H
@@ -0,0 +1,59 @@
+#ifndef RING_SERIES_H
+
+#define RING_SERIES_H
+
+#include <array>
+#include <cstddef>
+
+// The last N values of a series, oldest first. push() is O(1) and never
+// allocates: once full, each value overwrites the oldest one.
+template <typename T, size_t N>
+class RingSeries {
+    static_assert(N > 0, "RingSeries needs room for at least one value");
+
+public:
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == N; }
+
+    void push(const T& value) {
+        size_t slot = m_start + m_size;
+        if (slot >= N) slot -= N;
+        m_values[slot] = value;
+        if (m_size < N) {
+            ++m_size;
+        } else if (++m_start == N) {
+            m_start = 0;
+        }
+    }
+
+    void clear() {
+        m_start = 0;
+        m_size = 0;
+    }
+
+    // 0 is the oldest value, size() - 1 the newest.
+    const T& operator[](size_t index) const {
+        size_t slot = m_start + index;
+        if (slot >= N) slot -= N;
+        return m_values[slot];
+    }
+    const T& front() const { return (*this)[0]; }
+    const T& back() const { return (*this)[m_size - 1]; }
+
+    // Calls f on every value, oldest first, as two contiguous runs.
+    template <typename F>
+    void forEach(F f) const {
+        size_t firstRun = m_size < N - m_start ? m_size : N - m_start;
+        for (size_t i = 0; i < firstRun; ++i) f(m_values[m_start + i]);
+        for (size_t i = 0; i < m_size - firstRun; ++i) f(m_values[i]);
+    }
+
+private:
+    std::array<T, N> m_values{};
+    size_t m_start = 0;
+    size_t m_size = 0;
+};
+
+#endif // RING_SERIES_H
@@ -0,0 +1,95 @@
+#ifndef SNAPSHOT_RECORDING_H
+
+#define SNAPSHOT_RECORDING_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "StatsSnapshot.h"
+
+// A recorded sampler stream: a header with the mount paths the disks were
+// sampled for, then one length-prefixed record per StatsSnapshot. Integers
+// are varints, PIDs are stored as the gap from the previous row, and owner
+// names are sent once and referred to by number afterwards, so a tick of
+// 20k processes takes a few hundred KB. Replaying needs no /proc.
+class SnapshotWriter {
+public:
+    SnapshotWriter() = default;
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // Truncates path. Returns false with error() set.
+    bool open(const std::string& path, const std::vector<std::string>& mountPaths);
+    void close();
+    bool isOpen() const { return m_file != nullptr; }
+    const std::string& error() const { return m_error; }
+
+    // Appends and flushes one record, so a recording cut short by a crash
+    // still replays up to its last tick.
+    bool write(const StatsSnapshot& snapshot);
+
+    // Encodes without writing, for a stream or for measuring the format.
+    // The record starts with its 4-byte length.
+    const std::vector<uint8_t>& encode(const StatsSnapshot& snapshot);
+    // The stream header open() writes.
+    static std::vector<uint8_t> encodeHeader(const std::vector<std::string>& mountPaths);
+    // Numbers owners afresh and sends each again with its next use, for a
+    // stream that a new reader joined partway.
+    void restartOwners() { m_owners.clear(); }
+
+private:
+    FILE* m_file = nullptr;
+    std::string m_error;
+    std::vector<uint8_t> m_buffer;
+    // Keyed by the interned name, holding a reference so the address is
+    // never reused for another name.
+    std::unordered_map<const std::string*, std::pair<OwnerHandle, uint32_t>> m_owners;
+    std::vector<const std::string*> m_newOwners;
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader() = default;
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    bool open(const std::string& path);
+    // Reads the stream a SnapshotServer serves on socketPath.
+    bool connect(const std::string& socketPath);
+    void close();
+    // The file or socket descriptor, -1 when closed.
+    int fd() const;
+    // Tells the server which SampleMetric and SampleField bits this reader
+    // wants. Safe to call from another thread than next().
+    bool requestPlan(unsigned metrics, unsigned processFields);
+    const std::string& error() const { return m_error; }
+    const std::vector<std::string>& mountPaths() const { return m_mountPaths; }
+
+    // Reads the next record into out. False at the end of the recording, or
+    // with error() set if the file is damaged.
+    bool next(StatsSnapshot& out);
+    // Starts over from the first record.
+    bool rewind();
+
+    // Decodes one record produced by SnapshotWriter::encode(), without its
+    // length prefix.
+    bool decode(const uint8_t* data, size_t size, StatsSnapshot& out);
+
+private:
+    bool readHeader(const std::string& name);
+
+    FILE* m_file = nullptr;
+    long m_firstRecord = 0;
+    std::string m_error;
+    std::vector<std::string> m_mountPaths;
+    std::vector<uint8_t> m_buffer;
+    std::vector<OwnerHandle> m_owners;
+};
+
+#endif // SNAPSHOT_RECORDING_H
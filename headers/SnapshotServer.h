@@ -0,0 +1,74 @@
+#ifndef SNAPSHOT_SERVER_H
+
+#define SNAPSHOT_SERVER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include "SnapshotRecording.h"
+
+// Serves StatsSnapshots to local viewers over a Unix domain socket, in the
+// recording format: a header when a viewer connects, then one record per
+// tick. A viewer asks for what it needs by sending its plan as 8 bytes,
+// the SampleMetric then the SampleField bits as little-endian uint32s, at
+// any time. The daemon samples the union of all plans, so every viewer
+// shares one pass over /proc.
+//
+// Single-threaded around poll(); a viewer that falls too far behind is
+// dropped rather than buffered without bound.
+class SnapshotServer {
+public:
+    SnapshotServer() = default;
+    ~SnapshotServer();
+
+    SnapshotServer(const SnapshotServer&) = delete;
+    SnapshotServer& operator=(const SnapshotServer&) = delete;
+
+    // $XDG_RUNTIME_DIR/guitaskmanager.sock, or a per-user name in /tmp.
+    static std::string defaultSocketPath();
+
+    // Binds path, which only the current user may connect to. A stale
+    // socket left by a crash is replaced; a live one is an error.
+    bool listen(const std::string& path, const std::vector<std::string>& mountPaths);
+    void close();
+    const std::string& error() const { return m_error; }
+
+    // Accepts viewers, reads their plans and sends queued output, waiting
+    // up to timeoutMs for any of it. Returns early on a signal.
+    void poll(int timeoutMs);
+
+    size_t clientCount() const { return m_clients.size(); }
+    // Union of the viewers' plans; 0 (MetricCore, SampleCore) with no viewers.
+    unsigned metrics() const;
+    unsigned processFields() const;
+
+    // Encodes the snapshot once and queues it for every viewer.
+    void publish(const StatsSnapshot& snapshot);
+
+private:
+    struct Client {
+        int fd = -1;
+        unsigned metrics = 0;
+        unsigned processFields = 0;
+        uint8_t request[8] = {};
+        size_t requestFill = 0;
+        std::vector<uint8_t> out;
+        size_t outSent = 0;
+    };
+
+    void accept();
+    bool receive(Client& client);
+    bool flush(Client& client);
+    void drop(size_t index);
+
+    int m_listenFd = -1;
+    std::string m_path;
+    std::string m_error;
+    std::vector<uint8_t> m_header;
+    SnapshotWriter m_encoder;
+    std::vector<Client> m_clients;
+    std::vector<pollfd> m_pollFds;
+};
+
+#endif // SNAPSHOT_SERVER_H
@@ -0,0 +1,110 @@
+#ifndef STATS_COLLECTOR_H
+
+#define STATS_COLLECTOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "SystemSampler.h"
+#include "StatsSnapshot.h"
+#include "MetricJournal.h"
+#include "SnapshotRecording.h"
+
+// Runs a SystemSampler on a timer inside its own thread. Each tick publishes
+// an immutable StatsSnapshot through an atomic shared_ptr swap; the UI picks
+// up the newest one with takeLatest() when snapshotReady() arrives.
+//
+// Move the collector to a QThread and connect QThread::started to start().
+class StatsCollector : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StatsCollector(std::vector<std::string> mountPaths, int intervalMs = 1000,
+                            unsigned processWorkers = ProcessSampler::defaultWorkerCount());
+    ~StatsCollector();
+
+    // Safe to call from any thread.
+    std::shared_ptr<const StatsSnapshot> latest() const;
+    std::shared_ptr<const StatsSnapshot> takeLatest();
+    // Changes what each tick collects. Anything the new plan adds is sampled
+    // right away instead of waiting for the next timer tick.
+    void setPlan(const SamplePlan& plan);
+    // Appends every tick to journal from the collector thread. Call before
+    // the thread starts; the journal is not touched from anywhere else after.
+    void setJournal(std::unique_ptr<MetricJournal> journal);
+    // Writes every snapshot to recorder, sampling everything while it is
+    // set so a replay can show any page. Call before the thread starts.
+    void setRecorder(std::unique_ptr<SnapshotWriter> recorder);
+    // Plays a recording back instead of sampling; /proc is never read.
+    // Snapshots keep their recorded spacing divided by speed, or with speed
+    // 0 each one follows as soon as the UI has taken the last. With loop
+    // the recording starts over at its end, shifted so time keeps moving
+    // forward. Call before the thread starts.
+    void setReplay(std::unique_ptr<SnapshotReader> reader, double speed, bool loop);
+    // Shows what a GUITaskManagerDaemon samples instead of sampling here,
+    // sending it the plan whenever that changes. If the daemon goes away
+    // the collector carries on sampling locally. Call before the thread
+    // starts, with a reader that is already connected.
+    void setRemote(std::unique_ptr<SnapshotReader> reader);
+
+public slots:
+    void start();
+    void requestSample();
+
+signals:
+    // Emitted at most once until the UI calls takeLatest(), so a busy UI
+    // never builds up a queue of stale snapshots.
+    void snapshotReady();
+    // The recording ran out; seconds is the wall time the replay took.
+    void replayFinished(int snapshots, double seconds);
+
+private slots:
+    void sampleNow();
+    void replayTick();
+    void readRemote();
+
+private:
+    void publish(std::shared_ptr<const StatsSnapshot> snapshot);
+    std::shared_ptr<StatsSnapshot> readReplay();
+    void startSampling();
+    void sendRemotePlan();
+    void deliver(std::shared_ptr<const StatsSnapshot> snapshot);
+
+    std::unique_ptr<SystemSampler> m_sampler;
+    std::vector<std::string> m_mountPaths;
+    QTimer* m_timer = nullptr;
+    int m_intervalMs;
+    unsigned m_processWorkers;
+
+    std::unique_ptr<MetricJournal> m_journal;
+    std::unique_ptr<SnapshotWriter> m_recorder;
+    bool m_recordEverything = false;    // set before start; readable from any thread
+
+    std::unique_ptr<SnapshotReader> m_replay;
+    double m_replaySpeed = 1.0;
+    bool m_replayLoop = false;
+    std::shared_ptr<StatsSnapshot> m_replayNext;
+    double m_replayOffset = 0.0;    // added to recorded timestamps; grows each loop
+    double m_replayEnd = 0.0;       // timestamp of the last snapshot read, offset included
+    int m_replayed = 0;
+    QElapsedTimer m_replayClock;
+    std::atomic<bool> m_replayWaiting{false}; // full speed: published, not yet taken
+
+    // Kept after a disconnect too: setPlan() may be using it from the UI thread.
+    std::unique_ptr<SnapshotReader> m_remote;
+    QSocketNotifier* m_remoteNotifier = nullptr;
+    std::atomic<bool> m_remoteActive{false};
+
+    std::shared_ptr<const StatsSnapshot> m_latest;
+    std::atomic<unsigned> m_metrics;
+    std::atomic<unsigned> m_processFields;
+    std::atomic<bool> m_pending{false};
+};
+
+#endif // STATS_COLLECTOR_H
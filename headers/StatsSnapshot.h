@@ -0,0 +1,83 @@
+#ifndef STATS_SNAPSHOT_H
+
+#define STATS_SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include "processParser.h"
+#include "CpuFreqSampler.h"
+#include "UidCache.h"
+
+// One process as the views see it, with rates already computed against the
+// previous sample.
+struct ProcessRow {
+    int pid = 0;
+    int ppid = 0;
+    char state = '?';
+    char name[16] = {};
+    OwnerHandle owner;
+    double cpuPercent = 0.0;
+    long memoryKb = 0;
+    long threads = 0;
+    int numaNode = -1;      // node of the CPU it last ran on
+    bool hasIo = false;
+    double readBytesPerSec = 0.0;
+    double writeBytesPerSec = 0.0;
+};
+
+struct DiskSample {
+    std::string mountPath;
+    std::string deviceName;
+    double activePercent = 0.0;
+    double readBytesPerSec = 0.0;
+    double writeBytesPerSec = 0.0;
+    DiskCounters counters;      // raw /proc/diskstats line for the device
+    FsInfo fsInfo;
+};
+
+// Optional parts of a tick. CPU, memory, disk and network counters are
+// always read: they are cheap and the history graphs need them every tick.
+enum SampleMetric : unsigned {
+    MetricCore        = 0,
+    MetricProcesses   = 1u << 0,  // process list, process and thread counts
+    MetricCpuDetails  = 1u << 1,  // per-CPU clock speeds, uptime, process and thread counts
+    MetricFilesystems = 1u << 2,  // statvfs for every disk
+    MetricPerCpu      = 1u << 3,  // utilisation of every logical processor
+    MetricAll         = MetricProcesses | MetricCpuDetails | MetricFilesystems | MetricPerCpu,
+};
+
+// Everything one tick produced. Built by the collector, then only ever read,
+// so the UI thread can hold on to it while the next one is being sampled.
+struct StatsSnapshot {
+    unsigned metrics = MetricCore; // SampleMetric bits that were collected
+    double timestamp = 0.0;     // seconds since the epoch
+    double intervalSec = 1.0;   // time since the previous snapshot
+
+    double cpuUsagePercent = 0.0;
+    std::vector<double> perCpuUsagePercent; // indexed by CPU number
+    // Averages of perCpuUsagePercent, filled with it.
+    std::vector<double> perSocketUsagePercent;
+    std::vector<double> perNodeUsagePercent;
+    CpuFreqSample cpuFreq;
+    std::string uptime;
+
+    MemInfo memInfo;
+    double memUsagePercent = 0.0;
+
+    double diskActivePercent = 0.0; // primary disk
+    std::vector<DiskSample> disks;  // same order as the mount paths the collector was given
+
+    double netSendBitsPerSec = 0.0;
+    double netRecvBitsPerSec = 0.0;
+
+    std::vector<ProcessRow> processes;
+    // Process CPU summed by the node each process last ran on, as a share
+    // of the whole machine. Filled with processes.
+    std::vector<double> perNodeProcessCpuPercent;
+    // Counted from the list with MetricProcesses; otherwise MetricCpuDetails
+    // fills them without reading any process's files.
+    long processCount = 0;
+    long totalThreads = 0;
+};
+
+#endif // STATS_SNAPSHOT_H
@@ -0,0 +1,84 @@
+#ifndef SYSTEM_SAMPLER_H
+
+#define SYSTEM_SAMPLER_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "processParser.h"
+#include "ProcessSampler.h"
+#include "CpuFreqSampler.h"
+#include "CpuTopology.h"
+#include "StatsSnapshot.h"
+
+// What the next tick should collect, derived from what is on screen.
+struct SamplePlan {
+    unsigned metrics = MetricAll;       // SampleMetric bits
+    unsigned processFields = SampleOwner; // SampleField bits, with MetricProcesses
+
+    bool operator==(const SamplePlan& other) const {
+        return metrics == other.metrics && processFields == other.processFields;
+    }
+    bool operator!=(const SamplePlan& other) const { return !(*this == other); }
+};
+
+// The sampling engine: reads every system and per-process counter for one
+// tick and turns it into a StatsSnapshot.
+class SystemSampler {
+public:
+    // processWorkers > 1 scans /proc with that many threads.
+    explicit SystemSampler(std::vector<std::string> mountPaths,
+                           unsigned processWorkers = ProcessSampler::defaultWorkerCount(),
+                           const SystemRoots& roots = SystemRoots());
+
+    // Parts left out of the plan are not read at all. Their rates are
+    // computed against the last tick that did read them.
+    std::shared_ptr<const StatsSnapshot> collect(const SamplePlan& plan);
+
+private:
+    struct DiskState {
+        std::string mountPath;
+        std::string deviceName;
+        int statsIndex = -1;        // row in m_diskStats last tick
+        DiskCounters prevCounters;
+    };
+
+    // Counters of the named device in this tick's m_diskStats, or zeros.
+    DiskCounters lookupDisk(const std::string& name, int& hint) const;
+
+    void collectPerCpu(StatsSnapshot& snapshot);
+    void collectProcesses(unsigned fields, long cpuTotal,
+                          std::chrono::steady_clock::time_point now,
+                          StatsSnapshot& snapshot);
+
+    ProcessParser m_parser;
+    ProcessSampler m_processSampler;
+    CpuFreqSampler m_freqSampler;
+    CpuTopology m_topology;
+    std::vector<ProcessSample> m_samples;
+
+    std::vector<DiskState> m_disks;
+    DiskStatsSnapshot m_diskStats;  // refilled every tick
+    std::string m_primaryDisk;      // whole disk holding /
+    int m_primaryDiskIndex = -1;
+
+    CpuTimes m_prevCpuTimes;
+    // Per-CPU counters are kept as separate contiguous arrays so the delta
+    // pass is a straight loop the compiler can vectorise.
+    std::vector<CpuTimes> m_perCpuTimes;
+    std::vector<long> m_cpuActive;
+    std::vector<long> m_cpuTotal;
+    std::vector<long> m_prevCpuActive;
+    std::vector<long> m_prevCpuTotal;
+    DiskCounters m_prevPrimaryDisk;
+    NetStats m_prevNetStats;
+    std::unordered_map<int, long> m_prevProcessJiffies;
+    std::unordered_map<int, IoStats> m_prevProcessIo;
+    long m_prevProcessCpuTotal = 0;
+    std::chrono::steady_clock::time_point m_lastSample;
+    std::chrono::steady_clock::time_point m_lastProcessSample;
+};
+
+#endif // SYSTEM_SAMPLER_H
@@ -0,0 +1,41 @@
+#ifndef UID_CACHE_H
+
+#define UID_CACHE_H
+
+#include <string>
+#include <memory>
+#include <chrono>
+#include <unordered_map>
+#include <sys/types.h>
+#include <time.h>
+
+// Interned user name. Every process owned by the same UID shares one string,
+// so copying an owner around costs a refcount bump instead of an allocation.
+using OwnerHandle = std::shared_ptr<const std::string>;
+
+class UidCache {
+public:
+    explicit UidCache(std::string passwdPath = "/etc/passwd");
+
+    // Names from the passwd file are loaded once; UIDs that are not in it
+    // (LDAP, sssd) are resolved through getpwuid_r and remembered, including
+    // misses, which map to the numeric UID.
+    OwnerHandle lookup(uid_t uid);
+    OwnerHandle lookup(const std::string& uid);
+
+    // Reloads when the passwd file's mtime changed. lookup() calls this at
+    // most once per second, so callers normally never need to.
+    void revalidate();
+
+private:
+    void load();
+    OwnerHandle resolveMiss(uid_t uid);
+
+    std::string m_passwdPath;
+    std::unordered_map<uid_t, OwnerHandle> m_names;
+    struct timespec m_mtime = {};
+    bool m_loaded = false;
+    std::chrono::steady_clock::time_point m_lastCheck;
+};
+
+#endif // UID_CACHE_H
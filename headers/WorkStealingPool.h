@@ -0,0 +1,54 @@
+#ifndef WORK_STEALING_POOL_H
+
+#define WORK_STEALING_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fork/join pool. run() spreads task indices over one deque per worker;
+// a worker drains its own deque from the back and, once empty, steals from
+// the front of the others. The calling thread acts as worker 0, so a pool of
+// N workers owns N - 1 threads.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned workers);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned workerCount() const { return static_cast<unsigned>(m_queues.size()); }
+
+    // Calls task(index, worker) for every index in [0, count) and returns
+    // once all of them have finished. Not reentrant.
+    void run(size_t count, const std::function<void(size_t, unsigned)>& task);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+
+    void workerLoop(unsigned worker);
+    bool runOne(unsigned worker);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(size_t, unsigned)>* m_task = nullptr;
+    uint64_t m_batch = 0;
+    unsigned m_busy = 0;
+    bool m_stop = false;
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -2,11 +2,13 @@
 
 # define PROCESSPARSER_H
 
+#include <cstdint>
 #include <string>
 #include <fstream>
 #include <vector>
 #include <filesystem>
 #include <map>
+#include "UidCache.h"
 
 class CpuTimes {
 public:
@@ -37,18 +39,33 @@ struct ProcessInfo {
     std::string name;
     std::string state;
     std::string ppid;
-    std::string owner;
+    OwnerHandle owner;
     long memoryKb = 0;
 };
 
+// /proc/meminfo, in kB except for the HugePages_ page counts.
 struct MemInfo {
     long memTotal = 0;
     long memFree = 0;
     long memAvailable = 0;
     long buffers = 0;
     long cached = 0;
+    long swapCached = 0;
     long swapTotal = 0;
     long swapFree = 0;
+    long shmem = 0;
+    long sReclaimable = 0;
+    long dirty = 0;
+    long writeback = 0;
+    long anonPages = 0;
+    long mapped = 0;
+    long hugePagesTotal = 0;
+    long hugePagesFree = 0;
+    long hugePagesRsvd = 0;
+    long hugePagesSurp = 0;
+    long hugePageSizeKb = 0;
+    long committedAs = 0;
+    long commitLimit = 0;
     
     long memUsed() const { return memTotal - memAvailable; }
     long swapUsed() const { return swapTotal - swapFree; }
@@ -60,17 +77,87 @@ struct DiskStats {
     long timeSpentIO = 0;
 };
 
+// Every counter of one /proc/diskstats line (fields 4-20). Kernels before
+// 4.18 have no discard fields and before 5.5 no flush fields; those read 0.
+struct DiskCounters {
+    unsigned major = 0;
+    unsigned minor = 0;
+    char name[32] = {};
+    uint64_t readsCompleted = 0;
+    uint64_t readsMerged = 0;
+    uint64_t sectorsRead = 0;
+    uint64_t msReading = 0;
+    uint64_t writesCompleted = 0;
+    uint64_t writesMerged = 0;
+    uint64_t sectorsWritten = 0;
+    uint64_t msWriting = 0;
+    uint64_t iosInProgress = 0;
+    uint64_t msDoingIo = 0;
+    uint64_t weightedMsDoingIo = 0;
+    uint64_t discardsCompleted = 0;
+    uint64_t discardsMerged = 0;
+    uint64_t sectorsDiscarded = 0;
+    uint64_t msDiscarding = 0;
+    uint64_t flushesCompleted = 0;
+    uint64_t msFlushing = 0;
+
+    DiskStats toDiskStats() const {
+        DiskStats stats;
+        stats.sectorsRead = static_cast<long>(sectorsRead);
+        stats.sectorsWritten = static_cast<long>(sectorsWritten);
+        stats.timeSpentIO = static_cast<long>(msDoingIo);
+        return stats;
+    }
+};
+
+// All of /proc/diskstats from one read, one entry per line in file order.
+// Refilled in place each tick so steady-state reads do not allocate.
+struct DiskStatsSnapshot {
+    std::vector<DiskCounters> devices;
+
+    // Index of the named device, or -1. A hint from the previous tick is
+    // checked first, since the table rarely changes between ticks.
+    int indexOf(const std::string& name, int hint = -1) const;
+    const DiskCounters* find(const std::string& name) const {
+        int index = indexOf(name);
+        return index >= 0 ? &devices[index] : nullptr;
+    }
+};
+
 struct NetStats {
     long bytesReceived = 0;
     long bytesSent = 0;
 };
 
+// The counters of one /proc/net/dev line.
+struct InterfaceCounters {
+    char name[32] = {};
+    uint64_t rxBytes = 0;
+    uint64_t rxPackets = 0;
+    uint64_t rxErrors = 0;
+    uint64_t rxDropped = 0;
+    uint64_t txBytes = 0;
+    uint64_t txPackets = 0;
+    uint64_t txErrors = 0;
+    uint64_t txDropped = 0;
+};
+
 struct FsInfo {
     long total = 0;
     long free = 0;
     long used() const { return total - free; }
 };
 
+// What /proc/cpuinfo says about the processor. None of it changes while the
+// system is up, so the parser reads it once.
+struct CpuInfo {
+    std::string vendor;
+    std::string modelName;
+    std::string cacheSize;
+    int coreCount = 0;      // distinct physical id / core id pairs
+    int logicalCount = 0;   // processor entries
+};
+
 struct AmdGpuInfo {
     std::string deviceName;
     std::string vendor;
@@ -82,12 +169,23 @@ struct AmdGpuInfo {
     std::string powerUsage;
 };
 
+// Where the parser looks for procfs, sysfs and /etc. Point these at a
+// captured or generated fixture tree to benchmark or regression-test the
+// parser without touching the live system.
+struct SystemRoots {
+    std::string proc = "/proc";
+    std::string sys = "/sys";
+    std::string etc = "/etc";
+};
+
 class ProcessParser {
     public:
      std::string getProcessorSpecs();
-    ProcessParser() = default;
+    explicit ProcessParser(SystemRoots roots = SystemRoots());
     ~ProcessParser() = default;
 
+    const SystemRoots& roots() const { return m_roots; }
+
     std::vector<std::string> readProcessFileSystem(const std::string& filePath);
 
     std::string getCurrentCpuMhz();
@@ -101,6 +199,10 @@ class ProcessParser {
     std::string getMountsInfo();
 
     CpuTimes getCpuTimes();
+    // Returns the aggregate line and fills perCpu, indexed by CPU number, from
+    // a single read of /proc/stat. Offline CPUs read as all zero. Does not
+    // allocate once the buffers have grown to the machine's size.
+    CpuTimes getPerCpuTimes(std::vector<CpuTimes>& perCpu);
 
     std::string getLoadAvg();
 
@@ -108,9 +210,17 @@ class ProcessParser {
 
     std::string getDeviceForMountPoint(std::string mountPath);
     DiskStats getDiskStats(std::string deviceName);
+    // Parses /proc/diskstats once into out; look devices up from it rather
+    // than calling getDiskStats() per device.
+    bool getDiskStatsSnapshot(DiskStatsSnapshot& out);
+    // "sda" for "sda1", "nvme0n1" for "nvme0n1p2"; other names unchanged.
+    std::string wholeDiskName(const std::string& partition);
 
 
     NetStats getNetworkStats();
+    // Every interface from one read of /proc/net/dev, in file order. out is
+    // refilled in place, so steady-state reads do not allocate.
+    bool getInterfaceCounters(std::vector<InterfaceCounters>& out);
     
     std::vector<std::string> getPids();
 
@@ -145,10 +255,19 @@ class ProcessParser {
 
     IoStats getProcessIoBytes(const std::string& pid);
 
+    // Parsed from /proc/cpuinfo on first use and cached.
+    const CpuInfo& getCpuInfo();
     int getCoreCount();
     int getLogicalProcessorCount();
     int getTotalThreads();
+    // Processes from the numeric entries of /proc, listed with getdents64
+    // into a reused buffer, and threads from the "running/total" field of
+    // /proc/loadavg, which counts every task the kernel schedules. Neither
+    // opens a per-process file, so this costs two syscalls' worth of work
+    // where getTotalThreads() reads every /proc/PID/status.
+    bool getTaskCounts(long& processes, long& threads);
     
+    // Every MemInfo field from one read of /proc/meminfo. Does not allocate.
     MemInfo getMemoryStats();
     FsInfo getFilesystemStats(const std::string& path);
     
@@ -156,6 +275,7 @@ class ProcessParser {
 
     AmdGpuInfo getAmdGpuStats();
 
+    // Cached after the first call.
     bool isRocmSmiAvailable();
 
     std::string formatAmdGpuInfoToJson(const AmdGpuInfo& info);
@@ -164,6 +284,23 @@ class ProcessParser {
     std::string getPrimaryNetworkInterface();
 
     std::vector<std::string> getMountedPartitions();
+
+private:
+    SystemRoots m_roots;
+    UidCache m_uidCache;
+    int m_rocmSmiAvailable = -1;
+    bool loadCpuInfo();
+    bool m_cpuInfoLoaded = false;
+    CpuInfo m_cpuInfo;
+    std::string m_statPath;
+    std::string m_meminfoPath;
+    std::string m_diskstatsPath;
+    std::vector<char> m_diskstatsBuffer;
+    std::string m_netDevPath;
+    std::vector<char> m_netDevBuffer;
+    std::vector<char> m_statBuffer;
+    std::string m_loadavgPath;
+    std::vector<char> m_direntBuffer;
 };
 
 
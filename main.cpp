@@ -1,11 +1,54 @@
 #include "mainwindow.h"
+#include "headers/CollectorDaemon.h"
+#include "headers/ProcessSampler.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
+    ProcessSampler::raiseFdLimit();
+
+    // A headless server has no display to open.
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--headless") == 0) {
+            return collectorDaemonMain(argc, argv);
+        }
+    }
+
     QApplication a(argc, argv);
-    MainWindow w;
+
+    QCommandLineParser cli;
+    cli.addHelpOption();
+    QCommandLineOption recordOption("record", "Also write every snapshot to <file>.", "file");
+    QCommandLineOption replayOption("replay", "Play back <file> instead of reading /proc.", "file");
+    QCommandLineOption speedOption("replay-speed", "Replay at <speed> times the recorded rate, or max.", "speed", "1");
+    QCommandLineOption loopOption("replay-loop", "Start the replay over when it ends.");
+    QCommandLineOption attachOption("attach", "Show what GUITaskManagerDaemon samples instead of reading /proc.");
+    QCommandLineOption socketOption("socket", "The daemon's socket for --attach.", "path");
+    QCommandLineOption headlessOption("headless", "Run as the collector daemon, without a window.");
+    cli.addOptions({recordOption, replayOption, speedOption, loopOption, attachOption, socketOption, headlessOption});
+    cli.process(a);
+
+    SessionOptions options;
+    options.recordPath = cli.value(recordOption);
+    options.replayPath = cli.value(replayOption);
+    options.replayLoop = cli.isSet(loopOption);
+    options.attach = cli.isSet(attachOption);
+    options.socketPath = cli.value(socketOption);
+    QString speed = cli.value(speedOption);
+    if (speed == "max") {
+        options.replaySpeed = 0.0;
+    } else {
+        bool ok = false;
+        options.replaySpeed = speed.toDouble(&ok);
+        if (!ok || options.replaySpeed <= 0.0) {
+            qWarning("--replay-speed takes a positive number or max");
+            return 1;
+        }
+    }
+
+    MainWindow w(options);
     w.show();
     return a.exec();
 }
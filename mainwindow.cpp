@@ -2,15 +2,56 @@
 #include "./ui_mainwindow.h"
 #include <QDebug>
 #include <QMap>
+#include <QHash>
 #include <QTreeWidgetItem>
 #include <QMessageBox>
 #include <QProcess>
 #include <QString>
 #include <QTableWidgetItem>
+#include <QSortFilterProxyModel>
 #include "headers/StartupManager.h"
+#include "headers/SnapshotServer.h"
 #include <QMenu>         
 #include <QTimer>        
 #include <QColor>              
+#include <QtNumeric>
+#include <QDateTime>
+#include <QCheckBox>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QHelpEvent>
+#include <QToolTip>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const int kGpuIntervalMs = 1000;
+static const double kHistorySeconds = 60.0;
+// Ticks the on-disk journal keeps: six hours at one a second, about 17 MB,
+// most of it the top processes.
+static const uint32_t kJournalTicks = 6 * 3600;
+
+// Largest finite value a series' graph holds, or floor if none is larger.
+// The line carries the bucket maxima, so peaks set the scale at every range.
+template <typename Series>
+static double seriesMax(const Series* series, double floor) {
+    double max = floor;
+    QSharedPointer<QCPGraphDataContainer> data = series->line->data();
+    for (auto it = data->constBegin(); it != data->constEnd(); ++it) {
+        if (!qIsNaN(it->value) && it->value > max) max = it->value;
+    }
+    return max;
+}
+
+// Appends one point to a graph and drops the ones that have scrolled out of
+// the window. QCPDataContainer appends in place and removes from the front
+// by growing its preallocated block, so nothing is copied per tick.
+static void appendPoint(QCPGraph* graph, double key, double value) {
+    QSharedPointer<QCPGraphDataContainer> data = graph->data();
+    data->add(QCPGraphData(key, value));
+    data->removeBefore(key - kHistorySeconds);
+}
 
 QString formatKB(long kb) {
     if (kb == 0) return "0.0 MB";
@@ -51,13 +92,23 @@ QString formatBytesRate(double bytesPerSec) {
     }
 }
 
-MainWindow::MainWindow(QWidget *parent)
+MainWindow::MainWindow(const SessionOptions& options, QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
 {
     ui->setupUi(this);
 ui->tabWidget->setCurrentIndex(0);
 
+    m_processModel = new ProcessTableModel(this);
+    m_processProxy = new QSortFilterProxyModel(this);
+    m_processProxy->setSourceModel(m_processModel);
+    m_processProxy->setSortRole(ProcessTableModel::SortRole);
+    m_processProxy->setDynamicSortFilter(true);
+    ui->processTable->setModel(m_processProxy);
+    ui->processTable->setColumnHidden(ProcessTableModel::ColStatus, true);
+    ui->processTable->setColumnHidden(ProcessTableModel::ColNode, true);
+    ui->processTable->setSortingEnabled(true);
+
     ui->processTable->setColumnWidth(0, 250);
     ui->processTable->setColumnWidth(1, 80); 
     ui->processTable->setColumnWidth(2, 80);  
@@ -74,12 +125,25 @@ ui->tabWidget->setCurrentIndex(0);
 
     m_servicesRefreshCounter = 0;
 
-    ui->detailsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
-    ui->detailsTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
-    ui->detailsTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
-    ui->detailsTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Interactive);
-    ui->detailsTable->horizontalHeader()->setSectionResizeMode(4, QHeaderView::ResizeToContents);
-    ui->detailsTable->horizontalHeader()->setSectionResizeMode(5, QHeaderView::ResizeToContents);
+    // Details is a second view on the same model, with its own sort order.
+    m_detailsProxy = new QSortFilterProxyModel(this);
+    m_detailsProxy->setSourceModel(m_processModel);
+    m_detailsProxy->setSortRole(ProcessTableModel::SortRole);
+    m_detailsProxy->setDynamicSortFilter(false);
+    ui->detailsTable->setModel(m_detailsProxy);
+    ui->detailsTable->setSortingEnabled(true);
+
+    // Name, PID, Status, Owner, CPU, Memory, as the tab always showed them.
+    QHeaderView *detailsHeader = ui->detailsTable->horizontalHeader();
+    detailsHeader->moveSection(detailsHeader->visualIndex(ProcessTableModel::ColStatus), 2);
+    detailsHeader->moveSection(detailsHeader->visualIndex(ProcessTableModel::ColOwner), 3);
+    detailsHeader->setSectionResizeMode(ProcessTableModel::ColName, QHeaderView::Stretch);
+    detailsHeader->setSectionResizeMode(ProcessTableModel::ColPid, QHeaderView::ResizeToContents);
+    detailsHeader->setSectionResizeMode(ProcessTableModel::ColStatus, QHeaderView::ResizeToContents);
+    detailsHeader->setSectionResizeMode(ProcessTableModel::ColOwner, QHeaderView::Interactive);
+    detailsHeader->setSectionResizeMode(ProcessTableModel::ColCpu, QHeaderView::ResizeToContents);
+    detailsHeader->setSectionResizeMode(ProcessTableModel::ColMemory, QHeaderView::ResizeToContents);
+    detailsHeader->setSectionResizeMode(ProcessTableModel::ColNode, QHeaderView::ResizeToContents);
 
     ui->resourceUsageLabel->setText("Recent system log entries (from journalctl / syslog):");
 
@@ -121,44 +185,126 @@ ui->tabWidget->setCurrentIndex(0);
 
     populateStartupTable();
 
-    processTimer = new QTimer(this);
-    connect(processTimer, &QTimer::timeout, this, &MainWindow::refreshStats);
-    
-    prevCpuTimes = parser.getCpuTimes();
+    // A replay brings its own disks; the pages must match its snapshots.
+    std::unique_ptr<SnapshotReader> replay;
+    if (!options.replayPath.isEmpty()) {
+        replay.reset(new SnapshotReader());
+        if (replay->open(options.replayPath.toStdString())) {
+            setWindowTitle(windowTitle() + " (replay: " + QFileInfo(options.replayPath).fileName() + ")");
+        } else {
+            qWarning() << "Cannot replay:" << QString::fromStdString(replay->error());
+            replay.reset();
+        }
+    }
+    // So does a daemon, though on this machine they are normally the same.
+    std::unique_ptr<SnapshotReader> remote;
+    if (!replay && options.attach) {
+        QString socketPath = options.socketPath.isEmpty()
+            ? QString::fromStdString(SnapshotServer::defaultSocketPath()) : options.socketPath;
+        remote.reset(new SnapshotReader());
+        if (remote->connect(socketPath.toStdString())) {
+            setWindowTitle(windowTitle() + " (attached: " + socketPath + ")");
+        } else {
+            qWarning() << "Cannot attach, sampling locally:" << QString::fromStdString(remote->error());
+            remote.reset();
+        }
+    }
+    setupPerformanceTab(replay ? replay->mountPaths()
+                        : remote ? remote->mountPaths() : parser.getMountedPartitions());
 
-    setupPerformanceTab();
-    m_prevNetStats = parser.getNetworkStats();
+    std::vector<std::string> mountPaths;
+    for (const DiskPageWidgets& page : m_diskPages) {
+        mountPaths.push_back(page.mountPath.toStdString());
+    }
 
-    m_currentGpuStats = parser.getAmdGpuStats();
-    
-    refreshStats();
-    processTimer->start(1000);
+    // The journal outlives the process, so the graphs start with whatever
+    // was recorded before a restart or a crash of the machine. A replay
+    // neither reads nor writes it: its timestamps are from another time.
+    std::unique_ptr<MetricJournal> journal;
+    if (!replay) {
+        journal.reset(new MetricJournal());
+        QString journalDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+        QDir().mkpath(journalDir);
+        if (journal->open((journalDir + "/metrics.journal").toStdString(), kJournalTicks)) {
+            loadJournal(*journal);
+        } else {
+            qWarning() << "Metric journal disabled:" << QString::fromStdString(journal->error());
+            journal.reset();
+        }
+    }
+
+    // Sampling runs on its own thread; refreshStats only renders what it publishes.
+    m_collectorThread = new QThread(this);
+    m_collector = new StatsCollector(mountPaths, 1000);
+    m_collector->setJournal(std::move(journal));
+    if (replay) {
+        m_collector->setReplay(std::move(replay), options.replaySpeed, options.replayLoop);
+        connect(m_collector, &StatsCollector::replayFinished, this, [](int snapshots, double seconds) {
+            qInfo().noquote() << QString("Replayed %1 snapshots in %2 s (%3 per second)")
+                .arg(snapshots).arg(seconds, 0, 'f', 2)
+                .arg(seconds > 0.0 ? snapshots / seconds : 0.0, 0, 'f', 1);
+        });
+    } else {
+        if (remote) {
+            m_collector->setRemote(std::move(remote));
+        }
+        if (!options.recordPath.isEmpty()) {
+            std::unique_ptr<SnapshotWriter> recorder(new SnapshotWriter());
+            if (recorder->open(options.recordPath.toStdString(), mountPaths)) {
+                m_collector->setRecorder(std::move(recorder));
+            } else {
+                qWarning() << "Cannot record:" << QString::fromStdString(recorder->error());
+            }
+        }
+    }
+    m_collector->setPlan(samplePlanForCurrentView());
+    m_collector->moveToThread(m_collectorThread);
+    connect(m_collectorThread, &QThread::started, m_collector, &StatsCollector::start);
+    connect(m_collectorThread, &QThread::finished, m_collector, &QObject::deleteLater);
+    connect(m_collector, &StatsCollector::snapshotReady,
+            this, &MainWindow::refreshStats, Qt::QueuedConnection);
+    m_collectorThread->start();
+
+    // The GPU has its own thread and cadence: a rocm-smi fallback can take
+    // a good fraction of a second and must not delay the stats tick.
+    m_gpuThread = new QThread(this);
+    m_gpuCollector = new GpuCollector(kGpuIntervalMs);
+    m_gpuCollector->moveToThread(m_gpuThread);
+    connect(m_gpuThread, &QThread::started, m_gpuCollector, &GpuCollector::start);
+    connect(m_gpuThread, &QThread::finished, m_gpuCollector, &QObject::deleteLater);
+    connect(m_gpuCollector, &GpuCollector::sampleReady,
+            this, &MainWindow::refreshGpu, Qt::QueuedConnection);
+    m_gpuThread->start();
+    updateSamplePlan();
 
 
 }
 
 MainWindow::~MainWindow()
 {
-    processTimer->stop();
+    m_collectorThread->quit();
+    m_gpuThread->quit();
+    m_collectorThread->wait();
+    m_gpuThread->wait();
     delete ui;
 }
 
 
 void MainWindow::on_terminateProcessButton_clicked()
 {
-    int currentRow = ui->processTable->currentRow();
-    if (currentRow < 0) {
+    QModelIndex current = ui->processTable->currentIndex();
+    if (!current.isValid()) {
         qDebug("No process selected.");
         return; 
     }
 
-    QTableWidgetItem *pidItem = ui->processTable->item(currentRow, 1);
-    if (!pidItem) {
-        qDebug("Could not find PID item for selected row.");
+    int pid = m_processModel->pidAt(m_processProxy->mapToSource(current).row());
+    if (pid < 0) {
+        qDebug("Could not find PID for selected row.");
         return; 
     }
 
-    QString pidString = pidItem->text();
+    QString pidString = QString::number(pid);
     std::string pid_std_string = pidString.toStdString();
 
     qDebug() << "Attempting to terminate PID:" << pidString;
@@ -171,7 +317,7 @@ void MainWindow::on_terminateProcessButton_clicked()
         qDebug() << "Failed to terminate process" << pidString;
     }
 
-    QTimer::singleShot(500, this, &MainWindow::refreshStats);
+    QTimer::singleShot(500, m_collector, &StatsCollector::requestSample);
 }
 
 void MainWindow::on_disconnectUserButton_clicked() 
@@ -199,7 +345,7 @@ void MainWindow::on_disconnectUserButton_clicked()
 
     QProcess::execute("pkill", QStringList() << "-u" << username);
 
-    QTimer::singleShot(500, this, &MainWindow::refreshStats);
+    QTimer::singleShot(500, m_collector, &StatsCollector::requestSample);
 }
 
 void MainWindow::on_disableStartupButton_clicked() 
@@ -318,8 +464,89 @@ void MainWindow::updateStartupButtonState()
     ui->disableStartupButton->setEnabled(true);
 }
 
+// Only what the visible tab (and Performance page) shows is sampled; CPU,
+// memory, disk and network counters are always read for the history graphs.
+SamplePlan MainWindow::samplePlanForCurrentView() const
+{
+    SamplePlan plan;
+    plan.metrics = MetricCore;
+    plan.processFields = SampleCore;
+
+    QWidget *tab = ui->tabWidget->currentWidget();
+    if (tab == ui->processesTab || tab == ui->detailsTab) {
+        plan.metrics |= MetricProcesses;
+        plan.processFields = SampleOwner;
+    } else if (tab == ui->usersTab) {
+        // Per-process I/O is only shown on the Users tab.
+        plan.metrics |= MetricProcesses;
+        plan.processFields = SampleOwner | SampleIo;
+    } else if (tab == ui->performanceTab) {
+        QWidget *page = ui->performanceStackedWidget->currentWidget();
+        if (page == ui->cpuPage) {
+            // MetricCpuDetails brings the process and thread counts; the
+            // process scan is only needed for the per-node process split.
+            plan.metrics |= MetricCpuDetails;
+            if (m_logicalCpusCheck->isChecked()) {
+                plan.metrics |= MetricPerCpu;
+                if (m_cpuTopology.nodeCount > 1) {
+                    plan.metrics |= MetricProcesses;
+                }
+            }
+        } else {
+            for (const DiskPageWidgets& diskPage : m_diskPages) {
+                if (page == diskPage.pageWidget) {
+                    plan.metrics |= MetricFilesystems;
+                    break;
+                }
+            }
+        }
+    }
+    return plan;
+}
+
+bool MainWindow::isGpuPage(const QWidget* page) const
+{
+    for (const GpuPageWidgets& gpuPage : m_gpuPages) {
+        if (gpuPage.pageWidget == page) return true;
+    }
+    return false;
+}
+
+bool MainWindow::gpuPageVisible() const
+{
+    return ui->tabWidget->currentWidget() == ui->performanceTab
+        && isGpuPage(ui->performanceStackedWidget->currentWidget());
+}
+
+void MainWindow::updateSamplePlan()
+{
+    if (m_collector) {
+        m_collector->setPlan(samplePlanForCurrentView());
+    }
+
+    if (m_gpuCollector) {
+        bool visible = gpuPageVisible();
+        if (m_gpuSampling && !visible) {
+            // Break the GPU graph lines over the time they are not sampled.
+            double now = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+            for (GpuPageWidgets& page : m_gpuPages) {
+                if (page.usage->history.revision(TierSeconds) == 0) continue;
+                for (PlotSeries* series : {page.usage, page.vram, page.temp, page.power}) {
+                    recordPoint(series, now, qQNaN());
+                }
+            }
+        }
+        m_gpuSampling = visible;
+        m_gpuCollector->setActive(visible);
+    }
+}
+
 void MainWindow::on_tabWidget_currentChanged(int index)
 {
+    updateSamplePlan();
+
+    updateProcessViewSorting();
+
     if (ui->tabWidget->widget(index) == ui->servicesTab) {
         m_servicesRefreshCounter = 0;
         populateServicesTable();    
@@ -330,6 +557,15 @@ void MainWindow::on_tabWidget_currentChanged(int index)
     }
 }
 
+// Both process views share m_processModel. Only the visible one re-sorts on
+// every tick; the hidden one catches up once when its tab is shown.
+void MainWindow::updateProcessViewSorting()
+{
+    QWidget *current = ui->tabWidget->currentWidget();
+    m_processProxy->setDynamicSortFilter(current == ui->processesTab);
+    m_detailsProxy->setDynamicSortFilter(current == ui->detailsTab);
+}
+
 void MainWindow::populateServicesTable()
 {
     int currentServiceRow = ui->servicesTable->currentRow();
@@ -499,19 +735,19 @@ void MainWindow::populateAppHistoryTable()
 
 void MainWindow::on_endTaskDetailsButton_clicked() 
 {
-    int currentRow = ui->detailsTable->currentRow();
-    if (currentRow < 0) {
+    QModelIndex current = ui->detailsTable->currentIndex();
+    if (!current.isValid()) {
         qDebug("No process selected in details table.");
         return; 
     }
 
-    QTableWidgetItem *pidItem = ui->detailsTable->item(currentRow, 1);
-    if (!pidItem) {
-        qDebug("Could not find PID item for selected row in details table.");
+    int pid = m_processModel->pidAt(m_detailsProxy->mapToSource(current).row());
+    if (pid < 0) {
+        qDebug("Could not find PID for selected row in details table.");
         return; 
     }
 
-    QString pidString = pidItem->text();
+    QString pidString = QString::number(pid);
     std::string pid_std_string = pidString.toStdString();
 
     qDebug() << "Attempting to terminate PID from details table:" << pidString;
@@ -524,7 +760,7 @@ void MainWindow::on_endTaskDetailsButton_clicked()
         qDebug() << "Failed to terminate process" << pidString;
     }
 
-    QTimer::singleShot(500, this, &MainWindow::refreshStats);
+    QTimer::singleShot(500, m_collector, &StatsCollector::requestSample);
 }
 
 
@@ -553,18 +789,253 @@ void MainWindow::setupGraph(QCustomPlot* graph, const QColor& color, bool twoLin
     graph->legend->setVisible(false);
 }
 
-void MainWindow::setupPerformanceTab()
+MainWindow::PlotSeries* MainWindow::addPlotSeries(QCustomPlot* plot, int graphIndex)
+{
+    std::unique_ptr<PlotSeries> series(new PlotSeries());
+    series->plot = plot;
+    series->line = plot->graph(graphIndex);
+    series->lineBrush = series->line->brush();
+    series->floor = plot->addGraph();
+    series->floor->setPen(QPen(series->line->pen().color().lighter(150)));
+    series->floor->setVisible(false);
+    m_plotSeries.push_back(std::move(series));
+    return m_plotSeries.back().get();
+}
+
+// Every sample goes to the history; at the 1 minute range the graph also
+// takes it directly, the rest are rebuilt from the history when drawn.
+void MainWindow::recordPoint(PlotSeries* series, double time, double value)
+{
+    series->history.add(time, value);
+    if (m_historySpan <= kHistorySeconds && series->shownTier == TierSeconds) {
+        appendPoint(series->line, time, value);
+    }
+}
+
+void MainWindow::showHistory(PlotSeries& series, double now)
+{
+    HistoryTier tier = MetricHistory::tierFor(m_historySpan);
+    bool live = m_historySpan <= kHistorySeconds;
+    if (series.shownTier == tier && (live || series.shownRevision == series.history.revision(tier))) {
+        return;
+    }
+
+    QVector<double> keys, maxima, minima;
+    series.history.forEach(tier, now - m_historySpan, [&](const HistoryPoint& point) {
+        keys.append(point.time);
+        maxima.append(point.max);
+        minima.append(point.min);
+    });
+    series.line->setData(keys, maxima, true);
+    series.floor->setData(keys, minima, true);
+
+    bool envelope = tier != TierSeconds;
+    series.floor->setVisible(envelope);
+    series.line->setChannelFillGraph(envelope ? series.floor : nullptr);
+    if (envelope) {
+        QColor color = series.line->pen().color();
+        color.setAlpha(70);
+        series.line->setBrush(QBrush(color));
+    } else {
+        series.line->setBrush(series.lineBrush);
+    }
+    series.shownTier = tier;
+    series.shownRevision = series.history.revision(tier);
+}
+
+// Brings a page's graphs up to the selected range, rescales them and redraws.
+void MainWindow::redrawPage(QWidget* page, double now)
+{
+    for (const std::unique_ptr<PlotSeries>& series : m_plotSeries) {
+        if (page->isAncestorOf(series->plot)) {
+            showHistory(*series, now);
+        }
+    }
+
+    if (page == ui->ethernetPage) {
+        double maxSpeed = qMax(100.0, qMax(seriesMax(m_netRecvSeries, 0.0), seriesMax(m_netSendSeries, 0.0)));
+        ui->ethernetGraph->yAxis->setRange(0, maxSpeed * 1.1);
+    }
+    for (const DiskPageWidgets& disk : m_diskPages) {
+        if (page == disk.pageWidget) {
+            double maxRate = qMax(seriesMax(disk.read, 1.0), seriesMax(disk.write, 1.0));
+            disk.throughputGraph->yAxis->setRange(0, maxRate * 1.1);
+        }
+    }
+    for (const GpuPageWidgets& gpu : m_gpuPages) {
+        if (page == gpu.pageWidget) {
+            const GpuSample& current = gpu.current;
+            double vramTotalMb = current.has(GpuVramTotal) ? current.vramTotalBytes / (1024.0 * 1024.0) : 0.0;
+            gpu.usageGraph->yAxis->setRange(0, 100);
+            gpu.vramGraph->yAxis->setRange(0, qMax(vramTotalMb, seriesMax(gpu.vram, 1.0)));
+            gpu.tempGraph->yAxis->setRange(0, qMax(100.0, seriesMax(gpu.temp, 0.0) * 1.1));
+            gpu.powerGraph->yAxis->setRange(0, seriesMax(gpu.power, 10.0) * 1.1);
+        }
+    }
+
+    for (QCustomPlot* graph : page->findChildren<QCustomPlot*>()) {
+        graph->xAxis->setRange(now, m_historySpan, Qt::AlignRight);
+        graph->replot();
+    }
+}
+
+// Replays the journal into the graphs' histories. Disk columns are matched
+// by mount path, since the disks may have changed since they were written.
+void MainWindow::loadJournal(const MetricJournal& journal)
+{
+    struct Feed {
+        PlotSeries* series;
+        JournalColumn column;
+        double scale;   // journal units to the graph's
+    };
+    std::vector<Feed> feeds = {
+        {m_cpuSeries, JournalCpuPercent, 1.0},
+        {m_memSeries, JournalMemPercent, 1.0},
+        {m_netSendSeries, JournalNetSendBits, 1.0 / 1000.0},
+        {m_netRecvSeries, JournalNetRecvBits, 1.0 / 1000.0},
+    };
+    for (const DiskPageWidgets& page : m_diskPages) {
+        for (unsigned disk = 0; disk < kJournalDisks; ++disk) {
+            if (journal.diskName(disk) == page.mountPath.toStdString()) {
+                feeds.push_back({page.active, journalDiskColumn(disk, 0), 1.0});
+                feeds.push_back({page.read, journalDiskColumn(disk, 1), 1.0 / (1024.0 * 1024.0)});
+                feeds.push_back({page.write, journalDiskColumn(disk, 2), 1.0 / (1024.0 * 1024.0)});
+                break;
+            }
+        }
+    }
+
+    // Breaks the lines over the time nothing was recorded.
+    const double gapSeconds = 5.0;
+    double previous = 0.0;
+    auto addGap = [&](double time) {
+        for (const Feed& feed : feeds) {
+            feed.series->history.add(time, qQNaN());
+        }
+    };
+    journal.forEachTick(0.0, [&](size_t tick) {
+        double time = journal.time(tick);
+        if (previous > 0.0 && time - previous > gapSeconds) {
+            addGap(previous + 1.0);
+        }
+        for (const Feed& feed : feeds) {
+            feed.series->history.add(time, journal.value(feed.column, tick) * feed.scale);
+        }
+        const JournalProcess* rows = journal.processes(tick);
+        if (rows[0].pid != 0) {
+            m_journalProcessTimes.push_back(time);
+            m_journalProcesses.insert(m_journalProcesses.end(), rows, rows + kJournalProcesses);
+        }
+        previous = time;
+    });
+    if (previous > 0.0) {
+        addGap(previous + 1.0);
+    }
+
+    for (const std::unique_ptr<PlotSeries>& series : m_plotSeries) {
+        series->shownTier = -1;
+    }
+}
+
+// Tooltip text for the journal tick nearest time, if one within slack
+// seconds kept processes; biggest first by memory or by CPU.
+QString MainWindow::journalProcessesAt(double time, double slack, bool byMemory) const
+{
+    const std::vector<double>& times = m_journalProcessTimes;
+    if (times.empty()) {
+        return QString();
+    }
+    auto next = std::lower_bound(times.begin(), times.end(), time);
+    auto nearest = next;
+    if (next == times.end() || (next != times.begin() && time - *(next - 1) < *next - time)) {
+        nearest = next - 1;
+    }
+    if (std::abs(*nearest - time) > slack) {
+        return QString();
+    }
+
+    size_t tick = static_cast<size_t>(nearest - times.begin());
+    std::vector<JournalProcess> rows;
+    for (unsigned i = 0; i < kJournalProcesses; ++i) {
+        const JournalProcess& row = m_journalProcesses[tick * kJournalProcesses + i];
+        if (row.pid != 0) rows.push_back(row);
+    }
+    std::sort(rows.begin(), rows.end(), [byMemory](const JournalProcess& a, const JournalProcess& b) {
+        return byMemory ? a.memoryKb > b.memoryKb : a.cpuPercent > b.cpuPercent;
+    });
+
+    QStringList lines;
+    lines << QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(*nearest * 1000.0)).toString("hh:mm:ss");
+    for (const JournalProcess& row : rows) {
+        QString name = QString::fromUtf8(row.name, static_cast<int>(strnlen(row.name, sizeof(row.name))));
+        QString owner = QString::fromUtf8(row.owner, static_cast<int>(strnlen(row.owner, sizeof(row.owner))));
+        QString who = owner.isEmpty() ? QString::number(row.pid) : QString("%1, %2").arg(row.pid).arg(owner);
+        lines << QString("%1 (%2)   %3 %   %4").arg(name, who)
+                     .arg(row.cpuPercent, 0, 'f', 1).arg(formatKB(static_cast<long>(row.memoryKb)).trimmed());
+    }
+    return lines.join("\n");
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip && (watched == ui->cpuGraph || watched == ui->memoryGraph)) {
+        QCustomPlot *graph = static_cast<QCustomPlot*>(watched);
+        QHelpEvent *help = static_cast<QHelpEvent*>(event);
+        double time = graph->xAxis->pixelToCoord(help->pos().x());
+        // A few pixels either way, and never less than the journal's gap.
+        double slack = qMax(5.0, 3.0 * m_historySpan / qMax(1, graph->axisRect()->width()));
+        QString text = journalProcessesAt(time, slack, watched == ui->memoryGraph);
+        if (text.isEmpty()) {
+            QToolTip::hideText();
+        } else {
+            QToolTip::showText(help->globalPos(), text, graph);
+        }
+        return true;
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+// Right edge for a page's graphs. The collector's pages follow its
+// snapshots, which run on the recording's clock during a replay; GPU pages
+// are always sampled live.
+double MainWindow::graphTime(const QWidget* page) const
+{
+    if (m_lastSampleTime > 0.0 && !isGpuPage(page)) {
+        return m_lastSampleTime;
+    }
+    return QDateTime::currentMSecsSinceEpoch() / 1000.0;
+}
+
+void MainWindow::setHistorySpan(double seconds)
+{
+    m_historySpan = seconds;
+    QString format = seconds <= 600 ? "hh:mm:ss" : seconds <= 86400 ? "hh:mm" : "ddd hh:mm";
+    for (const std::unique_ptr<PlotSeries>& series : m_plotSeries) {
+        series->shownTier = -1;
+        QSharedPointer<QCPAxisTickerDateTime> ticker =
+            qSharedPointerDynamicCast<QCPAxisTickerDateTime>(series->plot->xAxis->ticker());
+        if (ticker) {
+            ticker->setDateTimeFormat(format);
+        }
+    }
+    if (QWidget* page = ui->performanceStackedWidget->currentWidget()) {
+        redrawPage(page, graphTime(page));
+    }
+}
+
+void MainWindow::setupPerformanceTab(const std::vector<std::string>& mountPaths)
 {
     // --- 1. Get pointers to the pages from the .ui file ---
     // We need to keep them safe before we clear the stack.
     QWidget* cpuPage = ui->cpuPage;
     QWidget* memoryPage = ui->memoryPage;
     QWidget* ethernetPage = ui->ethernetPage;
-    QWidget* gpuPage = ui->gpuPage;
     
     // This is the original, unused disk page from the .ui file.
     // We will delete it. It's causing the crash.
     ui->diskPage->deleteLater(); 
+    // Likewise the single GPU page: every card gets a generated one instead.
+    ui->gpuPage->deleteLater();
 
     // --- 2. Remove all pages from the stacked widget ---
     // This gives us a clean slate to rebuild the order.
@@ -583,7 +1054,6 @@ void MainWindow::setupPerformanceTab()
     ui->performanceList->addItem("Memory");                
 
     // Add Dynamic Disks (Index 2, 3, ...)
-    std::vector<std::string> mountPaths = parser.getMountedPartitions();
     for (const std::string& path : mountPaths) {
         QString qPath = QString::fromStdString(path);
         
@@ -597,6 +1067,15 @@ void MainWindow::setupPerformanceTab()
         QCustomPlot* graph = new QCustomPlot();
         graph->setMinimumSize(0, 150);
         setupGraph(graph, Qt::green); // Setup the new graph
+
+        // Read in green, write in blue.
+        QCustomPlot* throughputGraph = new QCustomPlot();
+        throughputGraph->setMinimumSize(0, 100);
+        setupGraph(throughputGraph, QColor(0, 150, 0), true);
+        throughputGraph->yAxis->setLabel("MB/s");
+        PlotSeries* activeSeries = addPlotSeries(graph, 0);
+        PlotSeries* readSeries = addPlotSeries(throughputGraph, 0);
+        PlotSeries* writeSeries = addPlotSeries(throughputGraph, 1);
         
         QFormLayout* formLayout = new QFormLayout();
         QLabel* activeTimeLabel = new QLabel("0 %");
@@ -618,6 +1097,7 @@ void MainWindow::setupPerformanceTab()
         
         layout->addWidget(nameLabel);
         layout->addWidget(graph);
+        layout->addWidget(throughputGraph);
         layout->addLayout(formLayout);
         layout->addSpacerItem(new QSpacerItem(20, 40, QSizePolicy::Minimum, QSizePolicy::Expanding));
         // --- End of your disk page code ---
@@ -633,17 +1113,18 @@ void MainWindow::setupPerformanceTab()
         DiskPageWidgets pageWidgets;
         pageWidgets.pageWidget = diskPage;
         pageWidgets.graph = graph;
+        pageWidgets.throughputGraph = throughputGraph;
         pageWidgets.activeTimeLabel = activeTimeLabel;
         pageWidgets.readSpeedLabel = readSpeedLabel;
         pageWidgets.writeSpeedLabel = writeSpeedLabel;
         pageWidgets.capacityLabel = capacityLabel;
+        pageWidgets.active = activeSeries;
+        pageWidgets.read = readSeries;
+        pageWidgets.write = writeSeries;
         pageWidgets.mountPath = qPath;
 
 
         pageWidgets.deviceName = deviceName;
-        // Get initial stats for *this* device
-        pageWidgets.prevStats = parser.getDiskStats(pageWidgets.deviceName); 
-        pageWidgets.prevIOTime = pageWidgets.prevStats.timeSpentIO;
         
         m_diskPages.append(pageWidgets);
     }
@@ -653,94 +1134,214 @@ void MainWindow::setupPerformanceTab()
     std::string netIface = parser.getPrimaryNetworkInterface();
     ui->performanceList->addItem(QString("Ethernet (%1)").arg(QString::fromStdString(netIface)));
 
-    // Add GPU (Index N+1)
-    ui->performanceStackedWidget->addWidget(gpuPage); 
-    ui->performanceList->addItem("GPU 0");            
+    // Add one GPU page per card (Index N+1, ...)
+    std::vector<GpuDevice> gpus = GpuSampler::enumerate();
+    if (gpus.empty()) {
+        // No card sysfs can read; rocm-smi may still find one, so keep a page.
+        gpus.push_back(GpuDevice());
+    }
+    for (size_t i = 0; i < gpus.size(); ++i) {
+        addGpuPage(gpus[i], static_cast<int>(i));
+    }
     
 connect(ui->performanceList, &QListWidget::currentRowChanged,
         ui->performanceStackedWidget, &QStackedWidget::setCurrentIndex);
+
+    // How far back the graphs reach, under the page list. Past 10 minutes
+    // they are drawn from the 10 s and 1 min buckets.
+    m_historyRangeCombo = new QComboBox(ui->performanceTab);
+    const char* rangeNames[] = {"1 minute", "10 minutes", "1 hour", "6 hours", "24 hours", "7 days"};
+    const double rangeSeconds[] = {60, 600, 3600, 6 * 3600, 86400, 7 * 86400};
+    for (int i = 0; i < 6; ++i) {
+        m_historyRangeCombo->addItem(rangeNames[i], rangeSeconds[i]);
+    }
+    m_historyRangeCombo->setMaximumWidth(ui->performanceList->maximumWidth());
+    QVBoxLayout* listColumn = new QVBoxLayout();
+    ui->horizontalLayout_8->removeWidget(ui->performanceList);
+    listColumn->addWidget(ui->performanceList);
+    listColumn->addWidget(new QLabel("Time range:", ui->performanceTab));
+    listColumn->addWidget(m_historyRangeCombo);
+    ui->horizontalLayout_8->insertLayout(0, listColumn);
+    connect(m_historyRangeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        setHistorySpan(m_historyRangeCombo->itemData(index).toDouble());
+    });
             
     // --- 5. Setup labels and graphs ---
     ui->cpuNameLabel->setText(QString::fromStdString(parser.getProcessorSpecs()));
-    ui->coresLabel->setText(QString::number(parser.getCoreCount()));
+    m_cpuTopology = CpuTopology::read();
+    ui->coresLabel->setText(QString::number(m_cpuTopology.coreCount > 0
+                                            ? m_cpuTopology.coreCount : parser.getCoreCount()));
     ui->logicalProcessorsLabel->setText(QString::number(parser.getLogicalProcessorCount()));
     ui->netInterfaceLabel->setText(QString("Ethernet (%1)").arg(QString::fromStdString(netIface)));
     
     // Setup the graphs for the *original* ui pages
     setupGraph(ui->cpuGraph, Qt::blue);
+    m_cpuSeries = addPlotSeries(ui->cpuGraph, 0);
+
+    // Clock spread and a per-CPU heatmap, then the per-CPU graphs, which are
+    // only sampled while shown.
+    m_cpuFreqRangeLabel = new QLabel(ui->cpuPage);
+    m_cpuHeatmap = new CpuHeatmapWidget(ui->cpuPage);
+    m_logicalCpusCheck = new QCheckBox("Show logical processors", ui->cpuPage);
+    m_cpuGrid = new CpuGridWidget(ui->cpuPage);
+    m_cpuGrid->setVisible(false);
+    int cpuGraphIndex = ui->verticalLayout_8->indexOf(ui->cpuGraph);
+    ui->verticalLayout_8->insertWidget(cpuGraphIndex + 1, m_cpuFreqRangeLabel);
+    ui->verticalLayout_8->insertWidget(cpuGraphIndex + 2, m_cpuHeatmap);
+    ui->verticalLayout_8->insertWidget(cpuGraphIndex + 3, m_logicalCpusCheck);
+    ui->verticalLayout_8->insertWidget(cpuGraphIndex + 4, m_cpuGrid);
+
+    // Per-socket and per-node load, shown with the grid on multi-socket or
+    // NUMA machines, where imbalance between them matters.
+    m_cpuNodeUsageLabel = new QLabel(ui->cpuPage);
+    m_cpuNodeUsageLabel->setVisible(false);
+    ui->verticalLayout_8->insertWidget(cpuGraphIndex + 5, m_cpuNodeUsageLabel);
+    if (m_cpuTopology.socketCount() > 0) {
+        // Before the row's trailing spacer.
+        ui->horizontalLayout_7->insertWidget(ui->horizontalLayout_7->count() - 1, new QLabel(
+            QString("Sockets: %1   NUMA nodes: %2")
+                .arg(m_cpuTopology.socketCount()).arg(m_cpuTopology.nodeCount), ui->cpuPage));
+    }
+    connect(m_logicalCpusCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        if (!checked) {
+            m_cpuGrid->clear();
+        }
+        m_cpuGrid->setVisible(checked);
+        m_cpuNodeUsageLabel->setVisible(checked && (m_cpuTopology.socketCount() > 1 || m_cpuTopology.nodeCount > 1));
+        updateSamplePlan();
+    });
     setupGraph(ui->memoryGraph, Qt::magenta);
+    m_memSeries = addPlotSeries(ui->memoryGraph, 0);
+    // Hovering the past names the processes the journal kept for it.
+    ui->cpuGraph->installEventFilter(this);
+    ui->memoryGraph->installEventFilter(this);
+
+    // Composition bar under the usage line, and the extra meminfo fields
+    // after the form's existing rows.
+    m_memCompositionBar = new MemoryCompositionBar(ui->memoryPage);
+    ui->verticalLayout_10->insertWidget(ui->verticalLayout_10->indexOf(ui->memoryGraph) + 2, m_memCompositionBar);
+    QLabel** memLabels[] = {&m_memCommittedLabel, &m_memSharedLabel, &m_memModifiedLabel, &m_memHugePagesLabel};
+    const char* memLabelNames[] = {"Committed:", "Shared:", "Modified:", "Huge pages:"};
+    for (int i = 0; i < 4; ++i) {
+        QLabel* label = new QLabel("0.0 GB", ui->memoryPage);
+        label->setFont(ui->memCachedLabel->font());
+        ui->formLayout->addRow(memLabelNames[i], label);
+        *memLabels[i] = label;
+    }
     // *** DO NOT setup ui->diskGraph, it was deleted. ***
     setupGraph(ui->ethernetGraph, Qt::cyan, true);
-    setupGraph(ui->gpuGraph, QColor(220, 50, 50));
+    m_netRecvSeries = addPlotSeries(ui->ethernetGraph, 0);
+    m_netSendSeries = addPlotSeries(ui->ethernetGraph, 1);
     
     // --- 6. Set initial page ---
     ui->performanceList->setCurrentRow(0);
 }
 
+void MainWindow::addGpuPage(const GpuDevice& device, int index)
+{
+    QWidget* gpuPage = new QWidget();
+    QVBoxLayout* layout = new QVBoxLayout(gpuPage);
+
+    QLabel* nameLabel = new QLabel(device.name.empty()
+                                   ? QString("GPU: Detecting...")
+                                   : QString::fromStdString(device.name));
+    nameLabel->setFont(ui->cpuNameLabel->font());
+
+    GpuPageWidgets pageWidgets;
+    pageWidgets.pageWidget = gpuPage;
+    pageWidgets.card = device.card;
+    pageWidgets.nameLabel = nameLabel;
+
+    QFormLayout* formLayout = new QFormLayout();
+    QLabel** labels[] = {&pageWidgets.usageLabel, &pageWidgets.clockLabel, &pageWidgets.tempLabel,
+                         &pageWidgets.vramLabel, &pageWidgets.fanLabel, &pageWidgets.powerLabel};
+    const char* labelNames[] = {"Usage:", "Clock:", "Temperature:", "VRAM Usage:", "Fan Speed:", "Power:"};
+    for (int i = 0; i < 6; ++i) {
+        QLabel* label = new QLabel("N/A");
+        QFont boldFont = label->font();
+        boldFont.setBold(true);
+        label->setFont(boldFont);
+        formLayout->addRow(labelNames[i], label);
+        *labels[i] = label;
+    }
+
+    pageWidgets.usageGraph = new QCustomPlot();
+    pageWidgets.usageGraph->setMinimumSize(0, 150);
+    setupGraph(pageWidgets.usageGraph, QColor(220, 50, 50));
+
+    // VRAM, temperature and power each get a smaller graph under the usage one.
+    QCustomPlot** graphs[] = {&pageWidgets.vramGraph, &pageWidgets.tempGraph, &pageWidgets.powerGraph};
+    const QColor colors[] = {QColor(140, 70, 200), QColor(230, 130, 30), QColor(190, 160, 0)};
+    const char* axisLabels[] = {"VRAM (MB)", "Temperature (°C)", "Power (W)"};
+    for (int i = 0; i < 3; ++i) {
+        QCustomPlot* graph = new QCustomPlot();
+        graph->setMinimumSize(0, 100);
+        setupGraph(graph, colors[i]);
+        graph->yAxis->setLabel(axisLabels[i]);
+        *graphs[i] = graph;
+    }
+    pageWidgets.usage = addPlotSeries(pageWidgets.usageGraph, 0);
+    pageWidgets.vram = addPlotSeries(pageWidgets.vramGraph, 0);
+    pageWidgets.temp = addPlotSeries(pageWidgets.tempGraph, 0);
+    pageWidgets.power = addPlotSeries(pageWidgets.powerGraph, 0);
+
+    layout->addWidget(nameLabel);
+    layout->addLayout(formLayout);
+    layout->addWidget(pageWidgets.usageGraph);
+    layout->addWidget(pageWidgets.vramGraph);
+    layout->addWidget(pageWidgets.tempGraph);
+    layout->addWidget(pageWidgets.powerGraph);
+    layout->addSpacerItem(new QSpacerItem(20, 40, QSizePolicy::Minimum, QSizePolicy::Expanding));
+
+    ui->performanceStackedWidget->addWidget(gpuPage);
+    ui->performanceList->addItem(QString("GPU %1").arg(index));
+
+    m_gpuPages.append(pageWidgets);
+}
+
 
 
 void MainWindow::on_performanceList_currentRowChanged(int row)
 {
     ui->performanceStackedWidget->setCurrentIndex(row);
-    switch(row) {
-        case 0: ui->cpuGraph->replot(); break;
-        case 1: ui->memoryGraph->replot(); break;
-        case 2: ui->diskGraph->replot(); break;
-        case 3: ui->ethernetGraph->replot(); break;
+    updateSamplePlan();
+    // Rows past Memory are generated pages (the .ui diskGraph is deleted),
+    // so redraw whatever graphs the page holds.
+    if (QWidget* page = ui->performanceStackedWidget->widget(row)) {
+        redrawPage(page, graphTime(page));
     }
 }
 
 void MainWindow::refreshStats()
 {
-
-    CpuTimes currentCpuTimes = parser.getCpuTimes();
-    long deltaTotal = currentCpuTimes.totalTime() - prevCpuTimes.totalTime();
-    long deltaIdle = currentCpuTimes.totalIdleTime() - prevCpuTimes.totalIdleTime();
-    double cpuUsagePercent = 0.0;
-    if (deltaTotal > 0) {
-        cpuUsagePercent = (1.0 - (static_cast<double>(deltaIdle) / static_cast<double>(deltaTotal))) * 100.0;
-    }
-
-    MemInfo memInfo = parser.getMemoryStats();
-    double memUsagePercent = 0.0;
-    if (memInfo.memTotal > 0) {
-        memUsagePercent = (static_cast<double>(memInfo.memUsed()) / memInfo.memTotal) * 100.0;
+    std::shared_ptr<const StatsSnapshot> snapshot = m_collector->takeLatest();
+    if (!snapshot) {
+        return;
     }
 
-    double timeIntervalSec = processTimer->interval() / 1000.0;
+    const MemInfo& memInfo = snapshot->memInfo;
+    double cpuUsagePercent = snapshot->cpuUsagePercent;
+    double memUsagePercent = snapshot->memUsagePercent;
+    bool hasProcesses = snapshot->metrics & MetricProcesses;
 
-    DiskStats globalCurrentDiskStats = parser.getDiskStats();
-    long globalDeltaIOTime = globalCurrentDiskStats.timeSpentIO - m_prevDiskIOTime;
-    double diskActivePercent = (static_cast<double>(globalDeltaIOTime) / (timeIntervalSec * 1000.0)) * 100.0;
-    if (diskActivePercent > 100.0) diskActivePercent = 100.0;
+    for (int i = 0; i < m_diskPages.size() && i < static_cast<int>(snapshot->disks.size()); ++i) {
+        DiskPageWidgets& page = m_diskPages[i];
+        const DiskSample& disk = snapshot->disks[i];
 
-    for (DiskPageWidgets& page : m_diskPages) {
-        // --- ADD THIS NEW PER-PAGE LOGIC ---
-        
-        // 1. Get current stats for *this* specific device
-        DiskStats currentDiskStats = parser.getDiskStats(page.deviceName);
-        
-        // 2. Calculate deltas based on *this page's* previous stats
-     double readSpeed = (currentDiskStats.sectorsRead - page.prevStats.sectorsRead) * 512.0 / timeIntervalSec;
-        double writeSpeed = (currentDiskStats.sectorsWritten - page.prevStats.sectorsWritten) * 512.0 / timeIntervalSec;
-        
-        long deltaIOTime = currentDiskStats.timeSpentIO - page.prevIOTime;
-        double diskActivePercent = (static_cast<double>(deltaIOTime) / (timeIntervalSec * 1000.0)) * 100.0;
-        if (diskActivePercent > 100.0) diskActivePercent = 100.0;
-
-        // 3. Update this page's labels
-        page.activeTimeLabel->setText(QString::number(diskActivePercent, 'f', 0) + " %");
-        page.readSpeedLabel->setText(formatBytesRate(readSpeed));
-        page.writeSpeedLabel->setText(formatBytesRate(writeSpeed));
-        
-        // 5. Store current stats as previous stats for *this page*
-        page.prevStats = currentDiskStats;
-        page.prevIOTime = currentDiskStats.timeSpentIO;
+        page.activeTimeLabel->setText(QString::number(disk.activePercent, 'f', 0) + " %");
+        page.readSpeedLabel->setText(formatBytesRate(disk.readBytesPerSec));
+        page.writeSpeedLabel->setText(formatBytesRate(disk.writeBytesPerSec));
 
-        // --- END OF NEW LOGIC ---
+        double readMb = disk.readBytesPerSec / (1024.0 * 1024.0);
+        double writeMb = disk.writeBytesPerSec / (1024.0 * 1024.0);
+        recordPoint(page.active, snapshot->timestamp, disk.activePercent);
+        recordPoint(page.read, snapshot->timestamp, readMb);
+        recordPoint(page.write, snapshot->timestamp, writeMb);
 
-        // (This part is your old logic, which is fine)
-        page.fsInfo = parser.getFilesystemStats(page.mountPath.toStdString());
+        if (!(snapshot->metrics & MetricFilesystems)) {
+            continue;
+        }
+        page.fsInfo = disk.fsInfo;
         double usedGB = page.fsInfo.used() / (1024.0*1024.0*1024.0);
         double totalGB = page.fsInfo.total / (1024.0*1024.0*1024.0);
         page.capacityLabel->setText(QString("%1 / %2 GB")
@@ -748,118 +1349,63 @@ void MainWindow::refreshStats()
                                     .arg(totalGB, 0, 'f', 1));
     }
 
-    NetStats currentNetStats = parser.getNetworkStats();
-    double sendSpeed = (currentNetStats.bytesSent - m_prevNetStats.bytesSent) * 8.0 / timeIntervalSec;
-    double recvSpeed = (currentNetStats.bytesReceived - m_prevNetStats.bytesReceived) * 8.0 / timeIntervalSec;
-
+    double sendSpeed = snapshot->netSendBitsPerSec;
+    double recvSpeed = snapshot->netRecvBitsPerSec;
 
-    std::map<std::string, long> currentProcessJiffies;
-    std::map<std::string, IoStats> currentProcessIo;
-    
     QMap<QString, long> userMemoryMap;
     QMap<QString, double> userCpuMap;
     QMap<QString, double> userDiskReadMap; 
     QMap<QString, double> userDiskWriteMap;
 
-    ui->processTable->setSortingEnabled(false);
-    ui->processTable->setRowCount(0); 
-    ui->detailsTable->setSortingEnabled(false);
-    ui->detailsTable->setRowCount(0);
-    ui->usersTreeWidget->clear();
-
-    std::vector<std::string> pids = parser.getPids();
-    for (const std::string& pid_std : pids) 
-    {
-        ProcessInfo info = parser.getProcessInfo(pid_std);
-        
-        long currentJiffies = parser.getProcessActiveJiffies(pid_std);
-        currentProcessJiffies[pid_std] = currentJiffies;
-        long prevJiffies = 0;
-        auto it = prevProcessJiffies.find(pid_std);
-        if (it != prevProcessJiffies.end()) prevJiffies = it->second;
-        long deltaProc = currentJiffies - prevJiffies;
-        double procCpuPercent = 0.0;
-        if (deltaTotal > 0) {
-            procCpuPercent = (static_cast<double>(deltaProc) / static_cast<double>(deltaTotal)) * 100.0;
-        }
-
-        IoStats currentIo = parser.getProcessIoBytes(pid_std);
-        currentProcessIo[pid_std] = currentIo;
-        IoStats prevIo;
-        auto io_it = prevProcessIo.find(pid_std);
-        if (io_it != prevProcessIo.end()) prevIo = io_it->second;
-
-        double readRate = (static_cast<double>(currentIo.readBytes - prevIo.readBytes)) / timeIntervalSec;
-        double writeRate = (static_cast<double>(currentIo.writeBytes - prevIo.writeBytes)) / timeIntervalSec;
-
-        int row = ui->processTable->rowCount();
-        ui->processTable->insertRow(row);
-        
-        bool ok;
-        QTableWidgetItem *nameItem = new QTableWidgetItem(QString::fromStdString(info.name));
-        QTableWidgetItem *pidItem = new QTableWidgetItem();
-        qlonglong pidNum = QString::fromStdString(info.pid).toLongLong(&ok);
-        if (ok) pidItem->setData(Qt::DisplayRole, pidNum);
-        else pidItem->setText(QString::fromStdString(info.pid)); 
-        
-        QTableWidgetItem *cpuItem = new QTableWidgetItem();
-        cpuItem->setData(Qt::DisplayRole, procCpuPercent); 
-
-        QTableWidgetItem *memItem = new QTableWidgetItem();
-        memItem->setData(Qt::DisplayRole, static_cast<qlonglong>(info.memoryKb));
-        
-        QTableWidgetItem *userItem = new QTableWidgetItem(QString::fromStdString(info.owner));
+    // A snapshot without the process list would empty the tables; keep the
+    // last one until the tab that needs it is shown again.
+    if (hasProcesses) {
+        m_processModel->updateFromSnapshot(*snapshot);
+    }
 
-        ui->processTable->setItem(row, 0, nameItem);
-        ui->processTable->setItem(row, 1, pidItem);
-        ui->processTable->setItem(row, 2, cpuItem);
-        ui->processTable->setItem(row, 3, memItem);
-        ui->processTable->setItem(row, 4, userItem);
+    if (hasProcesses && ui->tabWidget->currentWidget() == ui->usersTab) {
+        ui->usersTreeWidget->clear();
+
+        QHash<const std::string*, QString> ownerNames;
+        for (const ProcessRow& process : snapshot->processes) 
+        {
+            // Owners are interned, so each distinct user is converted once per tick.
+            QString owner("N/A");
+            if (process.owner) {
+                auto nameIt = ownerNames.find(process.owner.get());
+                if (nameIt == ownerNames.end()) {
+                    nameIt = ownerNames.insert(process.owner.get(), QString::fromStdString(*process.owner));
+                }
+                owner = nameIt.value();
+            }
 
-        int detailsRow = ui->detailsTable->rowCount();
-        ui->detailsTable->insertRow(detailsRow);
-        
-        QTableWidgetItem *d_pidItem = new QTableWidgetItem();
-        d_pidItem->setData(Qt::DisplayRole, pidNum);
-        
-        ui->detailsTable->setItem(detailsRow, 0, nameItem->clone());
-        ui->detailsTable->setItem(detailsRow, 1, d_pidItem);
-        ui->detailsTable->setItem(detailsRow, 2, new QTableWidgetItem(QString::fromStdString(info.state)));
-        ui->detailsTable->setItem(detailsRow, 3, userItem->clone());
-        ui->detailsTable->setItem(detailsRow, 4, cpuItem->clone());
-        ui->detailsTable->setItem(detailsRow, 5, memItem->clone());
-
-        QString user = QString::fromStdString(info.owner);
-        userMemoryMap[user] += info.memoryKb;
-        userCpuMap[user] += procCpuPercent;
-        userDiskReadMap[user] += readRate;
-        userDiskWriteMap[user] += writeRate;
-    }
+            userMemoryMap[owner] += process.memoryKb;
+            userCpuMap[owner] += process.cpuPercent;
+            userDiskReadMap[owner] += process.readBytesPerSec;
+            userDiskWriteMap[owner] += process.writeBytesPerSec;
+        }
     
-    for (auto it = userMemoryMap.constBegin(); it != userMemoryMap.constEnd(); ++it) {
-        QString user = it.key();
-        long memoryKb = it.value();
-        double cpu = userCpuMap.value(user, 0.0);
-        double diskRead = userDiskReadMap.value(user, 0.0);
-        double diskWrite = userDiskWriteMap.value(user, 0.0);
-
-        QTreeWidgetItem *item = new QTreeWidgetItem(ui->usersTreeWidget);
+        for (auto it = userMemoryMap.constBegin(); it != userMemoryMap.constEnd(); ++it) {
+            QString user = it.key();
+            long memoryKb = it.value();
+            double cpu = userCpuMap.value(user, 0.0);
+            double diskRead = userDiskReadMap.value(user, 0.0);
+            double diskWrite = userDiskWriteMap.value(user, 0.0);
+
+            QTreeWidgetItem *item = new QTreeWidgetItem(ui->usersTreeWidget);
         
-        QString diskString = QString("R: %1 | W: %2")
-                                   .arg(formatBytesRate(diskRead))
-                                   .arg(formatBytesRate(diskWrite));
-
-        item->setText(0, user);
-        item->setData(1, Qt::DisplayRole, cpu);
-        item->setData(2, Qt::DisplayRole, static_cast<qlonglong>(memoryKb)); 
-        item->setText(3, diskString); 
-        item->setText(4, "N/A");      
+            QString diskString = QString("R: %1 | W: %2")
+                                       .arg(formatBytesRate(diskRead))
+                                       .arg(formatBytesRate(diskWrite));
+
+            item->setText(0, user);
+            item->setData(1, Qt::DisplayRole, cpu);
+            item->setData(2, Qt::DisplayRole, static_cast<qlonglong>(memoryKb)); 
+            item->setText(3, diskString); 
+            item->setText(4, "N/A");      
+        }
     }
 
-    ui->processTable->setSortingEnabled(true);
-    ui->detailsTable->setSortingEnabled(true);
-
-
 
 
     m_servicesRefreshCounter++;
@@ -870,72 +1416,55 @@ void MainWindow::refreshStats()
         }
     }
     
-  m_currentGpuStats = parser.getAmdGpuStats(); 
-
-  std::string usageStr = m_currentGpuStats.gpuUsage;
-    double gpuUsagePercent = 0.0;
-    try {
-        size_t pos;
-        pos = usageStr.find(" ");
-        if (pos != std::string::npos) {
-            usageStr = usageStr.substr(0, pos); 
-        }
-        gpuUsagePercent = std::stod(usageStr);
-    } catch (const std::exception& e) {
-        gpuUsagePercent = 0.0; 
-    }
-
-    
-    QString gpuNameText = QString::fromStdString(m_currentGpuStats.deviceName);
-    QString gpuVendor = QString::fromStdString(m_currentGpuStats.vendor);
-
-    if (gpuNameText == "N/A" || gpuNameText.isEmpty()) {
-        ui->gpuNameLabel->setText("GPU: Detection Failed or N/A");
-    } else {
-        ui->gpuNameLabel->setText(gpuNameText + (gpuVendor != "N/A" ? " (" + gpuVendor + ")" : ""));
-    }
-
-    
-    ui->gpuUsageLabel->setText(QString("%1 %").arg(gpuUsagePercent, 0, 'f', 1));
-    QString temp = QString::fromStdString(m_currentGpuStats.gpuTemp);
-    ui->gpuTempLabel->setText(QString("%1 °C").arg(temp));
-    
-    QString vramText = QString("%1 / %2")
-        .arg(QString::fromStdString(m_currentGpuStats.vramUsed))
-        .arg(QString::fromStdString(m_currentGpuStats.vramTotal)); 
-    ui->gpuVramLabel->setText(QString("%1 MB").arg(vramText));
     
-    QString fan = QString::fromStdString(m_currentGpuStats.fanSpeed);
-    ui->gpuFanLabel->setText(QString("%1 RPM").arg(fan));
-    QString power = QString::fromStdString(m_currentGpuStats.powerUsage);
-ui->gpuPowerLabel->setText(QString("%1 W").arg(power));
-    
-  double currentTime = QDateTime::currentDateTime().toMSecsSinceEpoch() / 1000.0;
-    m_timeData.append(currentTime);
-    m_cpuData.append(cpuUsagePercent);
-    m_memData.append(memUsagePercent);
-    m_diskData.append(diskActivePercent);
-    m_netSendData.append(sendSpeed / 1000.0); 
-    m_netRecvData.append(recvSpeed / 1000.0);
-
-
-    m_gpuUsageData.append(gpuUsagePercent);
-
-    while (m_timeData.size() > 60) {
-        m_timeData.removeFirst();
-        m_cpuData.removeFirst();
-        m_memData.removeFirst();
-        m_diskData.removeFirst();
-        m_netSendData.removeFirst();
-        m_netRecvData.removeFirst();
-        m_gpuUsageData.removeFirst();
-    }
+  double currentTime = snapshot->timestamp;
+    m_lastSampleTime = currentTime;
+    recordPoint(m_cpuSeries, currentTime, cpuUsagePercent);
+    recordPoint(m_memSeries, currentTime, memUsagePercent);
+    recordPoint(m_netRecvSeries, currentTime, recvSpeed / 1000.0);
+    recordPoint(m_netSendSeries, currentTime, sendSpeed / 1000.0);
     
     ui->cpuUsageLabel->setText(QString::number(cpuUsagePercent, 'f', 1) + " %");
-    ui->cpuSpeedLabel->setText(QString::fromStdString(parser.getCurrentCpuMhz()));
-    ui->uptimeLabel->setText(QString::fromStdString(parser.getUptime()));
-    ui->processesLabel->setText(QString::number(pids.size()));
-    ui->threadsLabel->setText(QString::number(parser.getTotalThreads()));
+    if (snapshot->metrics & MetricCpuDetails) {
+        const CpuFreqSample& freq = snapshot->cpuFreq;
+        ui->cpuSpeedLabel->setText(QString("%1 GHz").arg(freq.avgMhz / 1000.0, 0, 'f', 2));
+        m_cpuFreqRangeLabel->setText(QString("Min %1 GHz   Avg %2 GHz   Max %3 GHz")
+            .arg(freq.minMhz / 1000.0, 0, 'f', 2)
+            .arg(freq.avgMhz / 1000.0, 0, 'f', 2)
+            .arg(freq.maxMhz / 1000.0, 0, 'f', 2));
+        m_cpuHeatmap->setFrequencies(freq.perCpuMhz, freq.ratedMaxMhz);
+        ui->uptimeLabel->setText(QString::fromStdString(snapshot->uptime));
+    }
+    if (snapshot->metrics & MetricPerCpu) {
+        m_cpuGrid->addSample(snapshot->perCpuUsagePercent);
+
+        QStringList parts;
+        if (snapshot->perSocketUsagePercent.size() > 1) {
+            // A replayed recording may come from a host with another socket
+            // layout; this host's package ids only apply when the counts match.
+            const std::vector<int>& socketIds = m_cpuTopology.socketIds;
+            bool hostIds = socketIds.size() == snapshot->perSocketUsagePercent.size();
+            for (size_t i = 0; i < snapshot->perSocketUsagePercent.size(); ++i) {
+                parts << QString("Socket %1: %2 %").arg(hostIds ? socketIds[i] : static_cast<int>(i))
+                             .arg(snapshot->perSocketUsagePercent[i], 0, 'f', 1);
+            }
+        }
+        const std::vector<double>& nodeProcessCpu = snapshot->perNodeProcessCpuPercent;
+        if (snapshot->perNodeUsagePercent.size() > 1) {
+            for (size_t i = 0; i < snapshot->perNodeUsagePercent.size(); ++i) {
+                QString part = QString("Node %1: %2 %").arg(i).arg(snapshot->perNodeUsagePercent[i], 0, 'f', 1);
+                if (i < nodeProcessCpu.size()) {
+                    part += QString(" (processes %1 %)").arg(nodeProcessCpu[i], 0, 'f', 1);
+                }
+                parts << part;
+            }
+        }
+        m_cpuNodeUsageLabel->setText(parts.join("    "));
+    }
+    if (snapshot->metrics & (MetricProcesses | MetricCpuDetails)) {
+        ui->processesLabel->setText(QString::number(snapshot->processCount));
+        ui->threadsLabel->setText(QString::number(snapshot->totalThreads));
+    }
 
 
 long memUsed = memInfo.memTotal - memInfo.memAvailable;
@@ -947,6 +1476,21 @@ ui->memUsageLabel->setText(QString("%1 / %2")
 ui->memUsedValueLabel->setText(formatKB(memUsed).trimmed());
 ui->memAvailableLabel->setText(formatKB(memInfo.memAvailable).trimmed());
 ui->memCachedLabel->setText(formatKB(memInfo.cached).trimmed());
+ui->memCachedLabel->setToolTip(QString("Buffers: %1\nReclaimable slab: %2")
+    .arg(formatKB(memInfo.buffers).trimmed())
+    .arg(formatKB(memInfo.sReclaimable).trimmed()));
+
+m_memCompositionBar->setMemInfo(memInfo);
+m_memCommittedLabel->setText(QString("%1 / %2")
+    .arg(formatKB(memInfo.committedAs).trimmed())
+    .arg(formatKB(memInfo.commitLimit).trimmed()));
+m_memSharedLabel->setText(formatKB(memInfo.shmem).trimmed());
+m_memModifiedLabel->setText(formatKB(memInfo.dirty + memInfo.writeback).trimmed());
+m_memHugePagesLabel->setText(memInfo.hugePagesTotal > 0
+    ? QString("%1 of %2 free (%3 each)")
+        .arg(memInfo.hugePagesFree).arg(memInfo.hugePagesTotal)
+        .arg(formatKB(memInfo.hugePageSizeKb).trimmed())
+    : QString("None"));
 
 long swapUsed = memInfo.swapTotal - memInfo.swapFree;
 
@@ -990,47 +1534,74 @@ ui->swapUsageLabel->setText(QString("%1 / %2")
     // }
 
 
-    int currentIndex = ui->performanceStackedWidget->currentIndex();
-    QWidget* currentPage = ui->performanceStackedWidget->widget(currentIndex);
-    QCustomPlot* currentGraph = currentPage->findChild<QCustomPlot*>();
+    // Every history already has this tick's point; only the visible page is
+    // brought up to date and redrawn. The GPU page is drawn by refreshGpu()
+    // at the GPU sampler's own cadence.
+    QWidget* currentPage = ui->performanceStackedWidget->currentWidget();
+    if (currentPage && !isGpuPage(currentPage)) {
+        redrawPage(currentPage, currentTime);
+    }
+}
+
+void MainWindow::refreshGpu()
+{
+    std::shared_ptr<const std::vector<GpuSample>> samples = m_gpuCollector->takeLatest();
+    if (!samples) {
+        return;
+    }
 
-    if (currentGraph) {
-        currentGraph->xAxis->setRange(currentTime, 60, Qt::AlignRight);
+    double currentTime = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+    bool visible = gpuPageVisible();
+    QWidget* currentPage = ui->performanceStackedWidget->currentWidget();
 
-        if (currentPage == ui->cpuPage) {
-            ui->cpuGraph->graph(0)->setData(m_timeData, m_cpuData);
-            ui->cpuGraph->yAxis->setRange(0, 100);
-        } else if (currentPage == ui->memoryPage) {
-            ui->memoryGraph->graph(0)->setData(m_timeData, m_memData);
-            ui->memoryGraph->yAxis->setRange(0, 100);
-        } else if (currentPage == ui->ethernetPage) {
-        } else if (currentPage == ui->gpuPage) {
-            ui->gpuGraph->graph(0)->setData(m_timeData, m_gpuUsageData);
-            ui->gpuGraph->yAxis->setRange(0, 100);
-        } else {
-            for (const DiskPageWidgets& page : m_diskPages) {
-                if (currentPage == page.pageWidget) {
-                    page.graph->graph(0)->setData(m_timeData, m_diskData);
-                    page.graph->yAxis->setRange(0, 100);
-                    break; 
-                }
+    for (GpuPageWidgets& page : m_gpuPages) {
+        for (const GpuSample& sample : *samples) {
+            if (sample.card == page.card) {
+                updateGpuPage(page, sample, currentTime, visible && page.pageWidget == currentPage);
+                break;
             }
         }
-        
-        currentGraph->replot();
     }
+}
 
-    if (ui->tabWidget->currentWidget() == ui->gpuPage) {
-        ui->gpuGraph->xAxis->setRange(currentTime, 60, Qt::AlignRight);
-        ui->gpuGraph->graph(0)->setData(m_timeData, m_gpuUsageData);
-        ui->gpuGraph->yAxis->setRange(0, 100);
-        ui->gpuGraph->replot();
-    }
+void MainWindow::updateGpuPage(GpuPageWidgets& page, const GpuSample& gpu, double currentTime, bool replot)
+{
+    page.current = gpu;
 
-    prevCpuTimes = currentCpuTimes;
-    prevProcessJiffies = currentProcessJiffies;
-    prevProcessIo = currentProcessIo;
-    m_prevNetStats = currentNetStats;
+    if (gpu.deviceName.empty()) {
+        page.nameLabel->setText("GPU: Detection Failed or N/A");
+    } else {
+        QString gpuVendor = QString::fromStdString(gpu.vendor);
+        page.nameLabel->setText(QString::fromStdString(gpu.deviceName)
+                                + (gpuVendor.isEmpty() ? "" : " (" + gpuVendor + ")"));
+    }
 
-    m_prevDiskIOTime = globalCurrentDiskStats.timeSpentIO;
-}
\ No newline at end of file
+    page.usageLabel->setText(gpu.has(GpuUsage)
+        ? QString("%1 %").arg(gpu.busyPercent, 0, 'f', 1) : QString("N/A"));
+    page.clockLabel->setText(gpu.has(GpuClock)
+        ? QString("%1 MHz").arg(gpu.clockMhz, 0, 'f', 0) : QString("N/A"));
+    page.tempLabel->setText(gpu.has(GpuTemperature)
+        ? QString("%1 °C").arg(gpu.temperatureC, 0, 'f', 1) : QString("N/A"));
+    page.vramLabel->setText(gpu.has(GpuVramUsed) && gpu.has(GpuVramTotal)
+        ? QString("%1 / %2").arg(formatKB(static_cast<long>(gpu.vramUsedBytes / 1024)))
+                            .arg(formatKB(static_cast<long>(gpu.vramTotalBytes / 1024)))
+        : QString("N/A"));
+    page.fanLabel->setText(gpu.has(GpuFan)
+        ? QString("%1 RPM").arg(gpu.fanRpm, 0, 'f', 0) : QString("N/A"));
+    page.powerLabel->setText(gpu.has(GpuPower)
+        ? QString("%1 W").arg(gpu.powerWatts, 0, 'f', 1) : QString("N/A"));
+
+    // Missing readings are stored as NaN, which the graphs draw as gaps.
+    double usage = gpu.has(GpuUsage) ? gpu.busyPercent : qQNaN();
+    double vramMb = gpu.has(GpuVramUsed) ? gpu.vramUsedBytes / (1024.0 * 1024.0) : qQNaN();
+    double temp = gpu.has(GpuTemperature) ? gpu.temperatureC : qQNaN();
+    double power = gpu.has(GpuPower) ? gpu.powerWatts : qQNaN();
+    recordPoint(page.usage, currentTime, usage);
+    recordPoint(page.vram, currentTime, vramMb);
+    recordPoint(page.temp, currentTime, temp);
+    recordPoint(page.power, currentTime, power);
+
+    if (replot) {
+        redrawPage(page.pageWidget, currentTime);
+    }
+}
@@ -3,16 +3,41 @@
 
 #include <QMainWindow>
 #include <QTimer>
+#include <QThread>
+#include <QSortFilterProxyModel>
 #include "headers/processParser.h"
+#include "headers/StatsCollector.h"
+#include "headers/GpuCollector.h"
+#include "headers/CpuGridWidget.h"
+#include "headers/CpuHeatmapWidget.h"
+#include "headers/CpuTopology.h"
+#include "headers/MemoryCompositionBar.h"
+#include "headers/MetricHistory.h"
+#include "headers/MetricJournal.h"
+#include <QCheckBox>
+#include <QComboBox>
+#include "headers/ProcessTableModel.h"
 #include <map> 
 #include "headers/StartupManager.h"
 #include "headers/ServiceManager.h"
 #include <QMessageBox>
 #include "headers/qcustomplot.h" 
 #include <QVector>
+#include <memory>
+#include <vector>
 
 
 
+// Where the window's snapshots come from, as given on the command line.
+struct SessionOptions {
+    QString recordPath;         // also write every snapshot here
+    QString replayPath;         // play this recording instead of reading /proc
+    double replaySpeed = 1.0;   // 0 replays as fast as the UI keeps up
+    bool replayLoop = false;
+    bool attach = false;        // show what GUITaskManagerDaemon samples
+    QString socketPath;         // the daemon's socket; empty for its default
+};
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MainWindow;
@@ -24,7 +49,7 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    MainWindow(const SessionOptions& options = SessionOptions(), QWidget *parent = nullptr);
     ~MainWindow();
 
 private slots:
@@ -47,17 +72,46 @@ private slots:
 
 
     void refreshStats();
+    void refreshGpu();
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
 private:
     Ui::MainWindow *ui;
-    QTimer *processTimer;
+    QThread *m_collectorThread = nullptr;
+    StatsCollector *m_collector = nullptr;
+    QThread *m_gpuThread = nullptr;
+    GpuCollector *m_gpuCollector = nullptr;
+    bool m_gpuSampling = false;
+    ProcessTableModel *m_processModel = nullptr;
+    QSortFilterProxyModel *m_processProxy = nullptr;
+    QSortFilterProxyModel *m_detailsProxy = nullptr;
     ProcessParser parser;
 
     StartupManager startupManager;
 
+    // One plotted metric: its history and the graph drawing it. Past the
+    // 1 s tier the line shows each bucket's max and floor its min, with the
+    // band between them filled.
+    struct PlotSeries {
+        QCustomPlot* plot = nullptr;
+        QCPGraph* line = nullptr;
+        QCPGraph* floor = nullptr;
+        QBrush lineBrush;   // as setupGraph left it, for the 1 s tier
+        MetricHistory history;
+        int shownTier = -1; // what the graphs hold; -1 until first drawn
+        unsigned long shownRevision = 0;
+    };
+    // Owned here so the pages, which are copied around in QLists, can keep
+    // plain pointers.
+    std::vector<std::unique_ptr<PlotSeries>> m_plotSeries;
+    QComboBox* m_historyRangeCombo = nullptr;
+    double m_historySpan = 60.0; // seconds shown on the Performance tab
+
 
     struct DiskPageWidgets {
         QWidget* pageWidget = nullptr;
         QCustomPlot* graph = nullptr;
+        QCustomPlot* throughputGraph = nullptr; // read and write, MB/s
         QLabel* activeTimeLabel = nullptr;
         QLabel* readSpeedLabel = nullptr;
         QLabel* writeSpeedLabel = nullptr;
@@ -67,40 +121,90 @@ private:
         FsInfo fsInfo; 
 
         std::string deviceName; // To store the device name, e.g., "sda1"
-    DiskStats prevStats;    // To store the previous stats for *this* disk
-    long prevIOTime;
+
+        // This device's own history; the pages no longer share one series.
+        PlotSeries* active = nullptr; // %
+        PlotSeries* read = nullptr;   // MB/s
+        PlotSeries* write = nullptr;  // MB/s
     };
     QList<DiskPageWidgets> m_diskPages;
-    CpuTimes prevCpuTimes;
-    std::map<std::string, long> prevProcessJiffies;
-    std::map<std::string, IoStats> prevProcessIo;
 
-    AmdGpuInfo m_currentGpuStats;
+    // One per card, built like the disk pages. Histories live with the page
+    // because the GPU is sampled on its own clock.
+    struct GpuPageWidgets {
+        QWidget* pageWidget = nullptr;
+        QLabel* nameLabel = nullptr;
+        QLabel* usageLabel = nullptr;
+        QLabel* clockLabel = nullptr;
+        QLabel* tempLabel = nullptr;
+        QLabel* vramLabel = nullptr;
+        QLabel* fanLabel = nullptr;
+        QLabel* powerLabel = nullptr;
+        QCustomPlot* usageGraph = nullptr;
+        QCustomPlot* vramGraph = nullptr;
+        QCustomPlot* tempGraph = nullptr;
+        QCustomPlot* powerGraph = nullptr;
+
+        std::string card;       // GpuDevice::card, e.g. "card0"
+        GpuSample current;
+
+        PlotSeries* usage = nullptr;
+        PlotSeries* vram = nullptr;   // MB
+        PlotSeries* temp = nullptr;   // °C
+        PlotSeries* power = nullptr;  // W
+    };
+    QList<GpuPageWidgets> m_gpuPages;
+
+    QLabel* m_cpuFreqRangeLabel = nullptr;
+    CpuHeatmapWidget* m_cpuHeatmap = nullptr;
+    QCheckBox* m_logicalCpusCheck = nullptr;
+    QLabel* m_cpuNodeUsageLabel = nullptr;
+    CpuTopology m_cpuTopology;
+
+    MemoryCompositionBar* m_memCompositionBar = nullptr;
+    QLabel* m_memCommittedLabel = nullptr;
+    QLabel* m_memSharedLabel = nullptr;
+    QLabel* m_memModifiedLabel = nullptr;
+    QLabel* m_memHugePagesLabel = nullptr;
+    CpuGridWidget* m_cpuGrid = nullptr;
 
     ServiceManager m_serviceManager;
     int m_servicesRefreshCounter;     
     void populateServicesTable();
     void populateAppHistoryTable();
+    SamplePlan samplePlanForCurrentView() const;
+    void updateSamplePlan();
+    bool isGpuPage(const QWidget* page) const;
+    bool gpuPageVisible() const;
+    void addGpuPage(const GpuDevice& device, int index);
+    void updateGpuPage(GpuPageWidgets& page, const GpuSample& gpu, double currentTime, bool replot);
+    void updateProcessViewSorting();
 
-    DiskStats m_prevDiskStats;
-    NetStats m_prevNetStats;
-    long m_prevDiskIOTime;
-
-    QVector<double> m_timeData;
-    QVector<double> m_cpuData;
-    QVector<double> m_memData;
-    QVector<double> m_diskData;
-    QVector<double> m_netSendData;
-    QVector<double> m_netRecvData;
+    PlotSeries* m_cpuSeries = nullptr;
+    PlotSeries* m_memSeries = nullptr;
+    PlotSeries* m_netSendSeries = nullptr;
+    PlotSeries* m_netRecvSeries = nullptr;
 
-    QVector<double> m_gpuUsageData;
 
     long m_lastReadBytes = 0;
     long m_lastWriteBytes = 0;
     QElapsedTimer m_diskTimer; 
 
 
-    void setupPerformanceTab();
+    void setupPerformanceTab(const std::vector<std::string>& mountPaths);
     void setupGraph(QCustomPlot* graph, const QColor& color, bool twoLines = false);
+    PlotSeries* addPlotSeries(QCustomPlot* plot, int graphIndex);
+    void recordPoint(PlotSeries* series, double time, double value);
+    void showHistory(PlotSeries& series, double now);
+    void redrawPage(QWidget* page, double now);
+    void setHistorySpan(double seconds);
+    void loadJournal(const MetricJournal& journal);
+    QString journalProcessesAt(double time, double slack, bool byMemory) const;
+    // The processes the journal kept, for the CPU and memory graph tooltips:
+    // the time of each tick that had them, and kJournalProcesses rows each.
+    std::vector<double> m_journalProcessTimes;
+    std::vector<JournalProcess> m_journalProcesses;
+    double graphTime(const QWidget* page) const;
+    double m_lastSampleTime = 0.0; // timestamp of the last snapshot shown
 };
 #endif // MAINWINDOW_H
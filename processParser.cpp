@@ -9,8 +9,23 @@
 #include <map>
 #include <iomanip> 
 #include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
 #include <signal.h>
+#include <unistd.h>
 #include <sys/statvfs.h>
+#include <sys/syscall.h>
+
+ProcessParser::ProcessParser(SystemRoots roots)
+    : m_roots(std::move(roots))
+    , m_uidCache(m_roots.etc + "/passwd")
+    , m_statPath(m_roots.proc + "/stat")
+    , m_meminfoPath(m_roots.proc + "/meminfo")
+    , m_diskstatsPath(m_roots.proc + "/diskstats")
+    , m_netDevPath(m_roots.proc + "/net/dev")
+    , m_loadavgPath(m_roots.proc + "/loadavg") {
+}
 
 std::vector<std::string> ProcessParser::readProcessFileSystem(const std::string& filePath) {
     std::vector<std::string> processes;
@@ -61,40 +76,60 @@ std::string getSpecValue(const std::string& line) {
 }
 
 
-std::string ProcessParser::getProcessorSpecs() {
-
-
-    std::map<std::string, std::string> specs = {
-        {"vendor_id", ""},
-        {"model name", ""},
-        {"cpu cores", ""},
-        {"cache size", ""}
-    };
-    size_t specsFound = 0;
+bool ProcessParser::loadCpuInfo() {
+    if (m_cpuInfoLoaded) {
+        return true;
+    }
 
-    std::ifstream processorSpecsFile("/proc/cpuinfo");
-    if (!processorSpecsFile.is_open()) {
-        throw std::runtime_error("Could not open file: /proc/cpuinfo");
+    std::ifstream stream(m_roots.proc + "/cpuinfo");
+    if (!stream.is_open()) {
+        return false;
     }
 
+    CpuInfo info;
+    std::set<std::string> coreIds;
+    std::string currentPhysicalId;
     std::string line;
-    while (specsFound < specs.size() && std::getline(processorSpecsFile, line)) {
-        for (auto const& [key, val] : specs) {
-            if (val.empty() && line.find(key) != std::string::npos) {
-                specs[key] = getSpecValue(line);
-                specsFound++;
-                break;
-            }
+    while (std::getline(stream, line)) {
+        if (line.find("processor") == 0) {
+            info.logicalCount++;
+        } else if (line.find("physical id") == 0) {
+            currentPhysicalId = getSpecValue(line);
+        } else if (line.find("core id") == 0) {
+            coreIds.insert(currentPhysicalId + ":" + getSpecValue(line));
+        } else if (info.vendor.empty() && line.find("vendor_id") == 0) {
+            info.vendor = getSpecValue(line);
+        } else if (info.modelName.empty() && line.find("model name") == 0) {
+            info.modelName = getSpecValue(line);
+        } else if (info.cacheSize.empty() && line.find("cache size") == 0) {
+            info.cacheSize = getSpecValue(line);
         }
     }
+    info.coreCount = coreIds.size() > 0 ? static_cast<int>(coreIds.size()) : 1;
+    if (info.logicalCount == 0) {
+        info.logicalCount = 1;
+    }
+
+    m_cpuInfo = std::move(info);
+    m_cpuInfoLoaded = true;
+    return true;
+}
 
-return specs["model name"];
+const CpuInfo& ProcessParser::getCpuInfo() {
+    loadCpuInfo();
+    return m_cpuInfo;
+}
 
+std::string ProcessParser::getProcessorSpecs() {
+    if (!loadCpuInfo()) {
+        throw std::runtime_error("Could not open file: " + m_roots.proc + "/cpuinfo");
+    }
+    return m_cpuInfo.modelName;
 }
 
 std::string ProcessParser::getCurrentCpuMhz() {
     std::string mhz = "0"; 
-    std::ifstream processorSpecsFile("/proc/cpuinfo");
+    std::ifstream processorSpecsFile(m_roots.proc + "/cpuinfo");
     if (!processorSpecsFile.is_open()) {
         return mhz; 
     }
@@ -112,34 +147,15 @@ std::string ProcessParser::getCurrentCpuMhz() {
 
 
 std::string ProcessParser::getMemoryInfo() { 
-    std::map<std::string, std::string> memSpecs = {
-        {"MemTotal", ""},
-        {"MemAvailable", ""},
-        {"SwapTotal", ""},
-        {"SwapFree", ""}
-    };
-    size_t specsFound = 0;
-    
-    std::ifstream memFile("/proc/meminfo");
-    if (!memFile.is_open()) {
-        throw std::runtime_error("Could not open file: /proc/meminfo");
-    }
-
-    std::string line;
-    while (specsFound < memSpecs.size() && std::getline(memFile, line)) {
-        for (auto const& [key, val] : memSpecs) {
-            if (val.empty() && line.find(key) != std::string::npos) {
-                memSpecs[key] = getSpecValue(line);
-                specsFound++;
-                break;
-            }
-        }
+    if (access(m_meminfoPath.c_str(), R_OK) != 0) {
+        throw std::runtime_error("Could not open file: " + m_meminfoPath);
     }
 
-    long memTotal = std::stol(memSpecs["MemTotal"]);
-    long memAvailable = std::stol(memSpecs["MemAvailable"]);
-    long swapTotal = std::stol(memSpecs["SwapTotal"]);
-    long swapFree = std::stol(memSpecs["SwapFree"]);
+    MemInfo info = getMemoryStats();
+    long memTotal = info.memTotal;
+    long memAvailable = info.memAvailable;
+    long swapTotal = info.swapTotal;
+    long swapFree = info.swapFree;
 
     float memUsagePercent = 0.0;
     if (memTotal > 0) {
@@ -162,9 +178,9 @@ std::string ProcessParser::getMemoryInfo() {
 }
 
 std::string ProcessParser::getUptime() {
-    std::ifstream uptimeFile("/proc/uptime");
+    std::ifstream uptimeFile(m_roots.proc + "/uptime");
     if (!uptimeFile.is_open()) {
-        throw std::runtime_error("Could not open file: /proc/uptime");
+        throw std::runtime_error("Could not open file: " + m_roots.proc + "/uptime");
     }
 
     double totalSeconds;
@@ -193,9 +209,9 @@ std::string ProcessParser::getUptime() {
 }
 
 std::string ProcessParser::getKernelVersion() {
-    std::ifstream versionFile("/proc/version");
+    std::ifstream versionFile(m_roots.proc + "/version");
     if (!versionFile.is_open()) {
-        throw std::runtime_error("Could not open file: /proc/version");
+        throw std::runtime_error("Could not open file: " + m_roots.proc + "/version");
     }
 
     std::string line;
@@ -211,9 +227,9 @@ std::string ProcessParser::getKernelVersion() {
     return kernelVersion;
 }
 std::string ProcessParser::getMountsInfo() {
-    std::ifstream mountsFile("/proc/mounts");
+    std::ifstream mountsFile(m_roots.proc + "/mounts");
     if (!mountsFile.is_open()) {
-        throw std::runtime_error("Could not open file: /proc/mounts");
+        throw std::runtime_error("Could not open file: " + m_roots.proc + "/mounts");
     }
 
     std::stringstream result;
@@ -237,9 +253,9 @@ std::string ProcessParser::getMountsInfo() {
 
 
 CpuTimes ProcessParser::getCpuTimes() {
-    std::ifstream statFile("/proc/stat");
+    std::ifstream statFile(m_roots.proc + "/stat");
     if (!statFile.is_open()) {
-        throw std::runtime_error("Could not open file: /proc/stat");
+        throw std::runtime_error("Could not open file: " + m_roots.proc + "/stat");
     }
 
     std::string line;
@@ -255,10 +271,86 @@ CpuTimes ProcessParser::getCpuTimes() {
     return times;
 }
 
+static const char* scanCpuField(const char* p, const char* end, long& value) {
+    while (p < end && *p == ' ') ++p;
+    long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p - '0');
+        ++p;
+    }
+    value = v;
+    return p;
+}
+
+static const char* scanCpuTimes(const char* p, const char* end, CpuTimes& times) {
+    p = scanCpuField(p, end, times.user);
+    p = scanCpuField(p, end, times.nice);
+    p = scanCpuField(p, end, times.system);
+    p = scanCpuField(p, end, times.idle);
+    p = scanCpuField(p, end, times.iowait);
+    p = scanCpuField(p, end, times.irq);
+    p = scanCpuField(p, end, times.softirq);
+    p = scanCpuField(p, end, times.steal);
+    return p;
+}
+
+CpuTimes ProcessParser::getPerCpuTimes(std::vector<CpuTimes>& perCpu) {
+    CpuTimes total = {};
+    std::fill(perCpu.begin(), perCpu.end(), CpuTimes{});
+
+    int fd = open(m_statPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + m_statPath);
+    }
+
+    // The cpu lines come first; the intr line after them can be tens of KB
+    // on big machines, so reading stops at the first line that is not a cpu.
+    size_t used = 0;
+    size_t scanned = 0;
+    bool complete = false;
+    while (!complete) {
+        if (m_statBuffer.size() - used < 4096) {
+            m_statBuffer.resize(std::max<size_t>(16384, m_statBuffer.size() * 2));
+        }
+        ssize_t len = read(fd, m_statBuffer.data() + used, m_statBuffer.size() - used);
+        if (len <= 0) {
+            break;
+        }
+        used += static_cast<size_t>(len);
+        for (; scanned + 1 < used; ++scanned) {
+            if (m_statBuffer[scanned] == '\n' && m_statBuffer[scanned + 1] != 'c') {
+                complete = true;
+                break;
+            }
+        }
+    }
+    close(fd);
+
+    const char* p = m_statBuffer.data();
+    const char* end = p + (complete ? scanned + 1 : used);
+    while (end - p > 3 && p[0] == 'c' && p[1] == 'p' && p[2] == 'u') {
+        p += 3;
+        if (*p == ' ') {
+            p = scanCpuTimes(p, end, total);
+        } else {
+            long cpu = 0;
+            p = scanCpuField(p, end, cpu);
+            if (static_cast<size_t>(cpu) >= perCpu.size()) {
+                perCpu.resize(static_cast<size_t>(cpu) + 1, CpuTimes{});
+            }
+            p = scanCpuTimes(p, end, perCpu[cpu]);
+        }
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!nl) break;
+        p = nl + 1;
+    }
+    return total;
+}
+
 std::string ProcessParser::getLoadAvg() {
-    std::ifstream loadFile("/proc/loadavg");
+    std::ifstream loadFile(m_roots.proc + "/loadavg");
     if (!loadFile.is_open()) {
-        throw std::runtime_error("Could not open file: /proc/loadavg");
+        throw std::runtime_error("Could not open file: " + m_roots.proc + "/loadavg");
     }
 
     float load1, load5, load15;
@@ -268,9 +360,9 @@ std::string ProcessParser::getLoadAvg() {
 }
 
 std::string ProcessParser::getSwapInfo() {
-    std::ifstream swapsFile("/proc/swaps");
+    std::ifstream swapsFile(m_roots.proc + "/swaps");
     if (!swapsFile.is_open()) {
-        throw std::runtime_error("Could not open file: /proc/swaps");
+        throw std::runtime_error("Could not open file: " + m_roots.proc + "/swaps");
     }
 
     long totalSize = 0;
@@ -336,7 +428,7 @@ bool is_numeric(const std::string& s) {
 std::vector<std::string> ProcessParser::getPids() {
     std::vector<std::string> pids;
 
-    const std::string proc_path = "/proc";
+    const std::string proc_path = m_roots.proc;
 
     try {
         for (const auto& entry : std::filesystem::directory_iterator(proc_path)) {
@@ -351,7 +443,7 @@ std::vector<std::string> ProcessParser::getPids() {
             }
         }
     } catch (std::filesystem::filesystem_error& e) {
-        throw std::runtime_error("Filesystem error while reading /proc " + std::string(e.what()));
+        throw std::runtime_error("Filesystem error while reading " + m_roots.proc + " " + std::string(e.what()));
     }
 
     return pids;
@@ -363,7 +455,7 @@ ProcessInfo ProcessParser::getProcessInfo(const std::string& pid) {
     info.pid = pid;
 
     std::string memString, uidString; 
-    std::string statusFilePath = "/proc/" + pid + "/status";
+    std::string statusFilePath = m_roots.proc + "/" + pid + "/status";
 
     std::map<std::string, std::string*> specMapping = {
         {"Name:", &info.name},
@@ -394,7 +486,7 @@ ProcessInfo ProcessParser::getProcessInfo(const std::string& pid) {
         std::stringstream ss(uidString);
         ss >> realUid; 
     }
-    info.owner = mapUidToUsername(realUid); 
+    info.owner = m_uidCache.lookup(realUid); 
 
     try {
         if (!memString.empty()) {
@@ -415,7 +507,7 @@ std::string ProcessParser::formatProcessInfoToJson(const ProcessInfo& info) {
     jsonOutput += "  \"pid\": \"" + info.pid + "\",\n";
     jsonOutput += "  \"name\": \"" + info.name + "\",\n";
     jsonOutput += "  \"state\": \"" + info.state + "\",\n";
-    jsonOutput += "  \"owner\": \"" + info.owner + "\",\n";
+    jsonOutput += "  \"owner\": \"" + (info.owner ? *info.owner : std::string()) + "\",\n";
     jsonOutput += "  \"ppid\": \"" + info.ppid + "\",\n";
     jsonOutput += "  \"memory_kb\": " + std::to_string(info.memoryKb) + "\n";
     jsonOutput += "}";
@@ -441,33 +533,11 @@ bool ProcessParser::terminateProcess(const std::string& pid) {
 
 
 std::string ProcessParser::mapUidToUsername(const std::string& uid) {
-    std::ifstream passwdFile("/etc/passwd");
-
-    if(!passwdFile.is_open()) {
-        return uid;
-    }
-
-    std::string line;
-
-    while (std::getline(passwdFile,line)) {
-        std::stringstream ss(line);
-
-        std::string username,placeholder,currentUid;
-
-        std::getline(ss,username,':');
-        std::getline(ss,placeholder,':');
-        std::getline(ss,currentUid,':');
-
-        if (currentUid == uid) {
-            return username;
-        }
-
-    }
-    return uid;
+    return *m_uidCache.lookup(uid);
 }
 
 std::string ProcessParser::getProcessOwner(const std::string& pid) {
-    std::ifstream statusFile("/proc/" + pid + "/status");
+    std::ifstream statusFile(m_roots.proc + "/" + pid + "/status");
 
     if(!statusFile.is_open()) {
         return "N/A";
@@ -489,7 +559,7 @@ std::string ProcessParser::getProcessOwner(const std::string& pid) {
 
 
 long ProcessParser::getProcessActiveJiffies(const std::string& pid) {
-    std::ifstream statFile("/proc/" + pid + "/stat");
+    std::ifstream statFile(m_roots.proc + "/" + pid + "/stat");
 
     if(!statFile.is_open()) {
         return 0;
@@ -521,7 +591,7 @@ long ProcessParser::getProcessActiveJiffies(const std::string& pid) {
 }
 
 std::string ProcessParser::getProcessIoStats(const std::string& pid) {
-    std::string ioFilePath = "/proc/" + pid + "/io";
+    std::string ioFilePath = m_roots.proc + "/" + pid + "/io";
     std::ifstream ioFile(ioFilePath);
     if (!ioFile.is_open()) {
         return "N/A";
@@ -553,7 +623,7 @@ std::string ProcessParser::getProcessIoStats(const std::string& pid) {
 }
 
 std::string ProcessParser::getProcessExecutablePath(const std::string& pid) {
-    std::string exePath = "/proc/" + pid + "/exe";
+    std::string exePath = m_roots.proc + "/" + pid + "/exe";
     std::string realPath;
     
     std::vector<char> buf(4096);
@@ -602,9 +672,9 @@ std::vector<std::string> ProcessParser::getLoggedInUsers() {
 
 
 std::string ProcessParser::getSystemDiskStats() {
-    std::ifstream diskStatsFile("/proc/diskstats");
+    std::ifstream diskStatsFile(m_roots.proc + "/diskstats");
     if (!diskStatsFile.is_open()) {
-        return "N/A (Could not open /proc/diskstats)";
+        return "N/A (Could not open " + m_roots.proc + "/diskstats)";
     }
 
     std::stringstream result;
@@ -686,7 +756,7 @@ std::string ProcessParser::getSystemLogs(int numLines) {
 
 
 IoStats ProcessParser::getProcessIoBytes(const std::string& pid) {
-    std::string ioFilePath = "/proc/" + pid + "/io";
+    std::string ioFilePath = m_roots.proc + "/" + pid + "/io";
     std::ifstream ioFile(ioFilePath);
     IoStats stats;
 
@@ -716,41 +786,17 @@ IoStats ProcessParser::getProcessIoBytes(const std::string& pid) {
 }
 
 int ProcessParser::getCoreCount() {
-    std::ifstream stream("/proc/cpuinfo");
-    if (!stream.is_open()) return 0;
-    std::string line;
-    std::set<std::string> coreIds;
-    std::string currentPhysicalId;
-
-    while (std::getline(stream, line)) {
-        if (line.find("physical id") == 0) {
-            currentPhysicalId = line.substr(line.find(":") + 2);
-        }
-        if (line.find("core id") == 0) {
-            std::string coreId = line.substr(line.find(":") + 2);
-            coreIds.insert(currentPhysicalId + ":" + coreId);
-        }
-    }
-    return coreIds.size() > 0 ? coreIds.size() : 1;
+    return loadCpuInfo() ? m_cpuInfo.coreCount : 0;
 }
 
 int ProcessParser::getLogicalProcessorCount() {
-    std::ifstream stream("/proc/cpuinfo");
-    if (!stream.is_open()) return 0;
-    std::string line;
-    int count = 0;
-    while (std::getline(stream, line)) {
-        if (line.find("processor") == 0) {
-            count++;
-        }
-    }
-    return count > 0 ? count : 1;
+    return loadCpuInfo() ? m_cpuInfo.logicalCount : 0;
 }
 
 int ProcessParser::getTotalThreads() {
     int totalThreads = 0;
     try {
-        for (const auto& entry : std::filesystem::directory_iterator("/proc")) {
+        for (const auto& entry : std::filesystem::directory_iterator(m_roots.proc)) {
             if (entry.is_directory()) {
                 std::string pid = entry.path().filename().string();
                 if (std::all_of(pid.begin(), pid.end(), ::isdigit)) {
@@ -770,36 +816,169 @@ int ProcessParser::getTotalThreads() {
     return totalThreads;
 }
 
-
-long getMemInfoValue(std::ifstream& stream, const std::string& key) {
-    stream.clear();
-    stream.seekg(0);
-    std::string line;
-    while (std::getline(stream, line)) {
-        if (line.find(key) == 0) {
-            try {
-                return std::stol(line.substr(line.find(":") + 1));
-            } catch (...) {
-                return 0;
+// The record getdents64 fills; glibc only declares it for _GNU_SOURCE.
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+bool ProcessParser::getTaskCounts(long& processes, long& threads) {
+    processes = 0;
+    threads = 0;
+
+    int dir = open(m_roots.proc.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir < 0) {
+        return false;
+    }
+    m_direntBuffer.resize(32768);
+    while (true) {
+        long len = syscall(SYS_getdents64, dir, m_direntBuffer.data(), m_direntBuffer.size());
+        if (len <= 0) break;
+        for (long offset = 0; offset < len;) {
+            const LinuxDirent64* entry = reinterpret_cast<const LinuxDirent64*>(m_direntBuffer.data() + offset);
+            // Nothing else in /proc starts with a digit.
+            if (entry->d_name[0] >= '0' && entry->d_name[0] <= '9') {
+                ++processes;
             }
+            offset += entry->d_reclen;
         }
     }
-    return 0;
+    close(dir);
+
+    // "0.52 0.58 0.59 2/1034 12345": the total after the slash.
+    char buffer[128];
+    int fd = open(m_loadavgPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    ssize_t used = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (used <= 0) {
+        return false;
+    }
+    buffer[used] = '\0';
+    const char* slash = std::strchr(buffer, '/');
+    if (!slash) {
+        return false;
+    }
+    threads = std::strtol(slash + 1, nullptr, 10);
+    return true;
 }
 
-MemInfo ProcessParser::getMemoryStats() {
-    MemInfo info;
-    std::ifstream stream("/proc/meminfo");
-    if (!stream.is_open()) return info;
 
-    info.memTotal = getMemInfoValue(stream, "MemTotal:");
-    info.memFree = getMemInfoValue(stream, "MemFree:");
-    info.memAvailable = getMemInfoValue(stream, "MemAvailable:");
-    info.buffers = getMemInfoValue(stream, "Buffers:");
-    info.cached = getMemInfoValue(stream, "Cached:");
-    info.swapTotal = getMemInfoValue(stream, "SwapTotal:");
-    info.swapFree = getMemInfoValue(stream, "SwapFree:");
+// /proc/meminfo keys are looked up through a perfect hash built at compile
+// time: each known name lands in its own slot, so a line costs one hash and
+// one compare. Unknown names hash to an empty slot or fail the compare.
+namespace {
+
+struct MemInfoField {
+    const char* name;
+    long MemInfo::*member;
+};
+
+constexpr MemInfoField kMemInfoFields[] = {
+    {"MemTotal", &MemInfo::memTotal},
+    {"MemFree", &MemInfo::memFree},
+    {"MemAvailable", &MemInfo::memAvailable},
+    {"Buffers", &MemInfo::buffers},
+    {"Cached", &MemInfo::cached},
+    {"SwapCached", &MemInfo::swapCached},
+    {"SwapTotal", &MemInfo::swapTotal},
+    {"SwapFree", &MemInfo::swapFree},
+    {"Shmem", &MemInfo::shmem},
+    {"SReclaimable", &MemInfo::sReclaimable},
+    {"Dirty", &MemInfo::dirty},
+    {"Writeback", &MemInfo::writeback},
+    {"AnonPages", &MemInfo::anonPages},
+    {"Mapped", &MemInfo::mapped},
+    {"HugePages_Total", &MemInfo::hugePagesTotal},
+    {"HugePages_Free", &MemInfo::hugePagesFree},
+    {"HugePages_Rsvd", &MemInfo::hugePagesRsvd},
+    {"HugePages_Surp", &MemInfo::hugePagesSurp},
+    {"Hugepagesize", &MemInfo::hugePageSizeKb},
+    {"Committed_AS", &MemInfo::committedAs},
+    {"CommitLimit", &MemInfo::commitLimit},
+};
+constexpr int kMemInfoFieldCount = sizeof(kMemInfoFields) / sizeof(kMemInfoFields[0]);
+
+constexpr unsigned kMemInfoSlots = 64;
+constexpr unsigned kMemInfoSeed = 13;   // first seed with no collisions
+
+constexpr unsigned memInfoHash(const char* key, size_t len) {
+    unsigned hash = 2166136261u ^ kMemInfoSeed;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(key[i])) * 16777619u;
+    }
+    return hash % kMemInfoSlots;
+}
+
+constexpr size_t constLength(const char* s) {
+    size_t len = 0;
+    while (s[len]) ++len;
+    return len;
+}
+
+struct MemInfoTable {
+    signed char slots[kMemInfoSlots] = {};
+    bool perfect = true;
+};
+
+constexpr MemInfoTable buildMemInfoTable() {
+    MemInfoTable table;
+    for (unsigned i = 0; i < kMemInfoSlots; ++i) table.slots[i] = -1;
+    for (int i = 0; i < kMemInfoFieldCount; ++i) {
+        const char* name = kMemInfoFields[i].name;
+        unsigned slot = memInfoHash(name, constLength(name));
+        if (table.slots[slot] >= 0) table.perfect = false;
+        table.slots[slot] = static_cast<signed char>(i);
+    }
+    return table;
+}
+
+constexpr MemInfoTable kMemInfoTable = buildMemInfoTable();
+static_assert(kMemInfoTable.perfect, "meminfo field names collide; pick another kMemInfoSeed");
+
+} // namespace
 
+MemInfo ProcessParser::getMemoryStats() {
+    MemInfo info;
+    int fd = open(m_meminfoPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return info;
+
+    // About 1.5 KB on current kernels.
+    char buf[8192];
+    size_t used = 0;
+    ssize_t len;
+    while (used < sizeof(buf) && (len = read(fd, buf + used, sizeof(buf) - used)) > 0) {
+        used += static_cast<size_t>(len);
+    }
+    close(fd);
+
+    const char* p = buf;
+    const char* end = buf + used;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = nl ? nl : end;
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', lineEnd - p));
+        if (colon) {
+            size_t keyLen = static_cast<size_t>(colon - p);
+            int field = kMemInfoTable.slots[memInfoHash(p, keyLen)];
+            if (field >= 0 && std::strncmp(kMemInfoFields[field].name, p, keyLen) == 0
+                && kMemInfoFields[field].name[keyLen] == '\0') {
+                const char* q = colon + 1;
+                while (q < lineEnd && *q == ' ') ++q;
+                long value = 0;
+                for (; q < lineEnd && *q >= '0' && *q <= '9'; ++q) {
+                    value = value * 10 + (*q - '0');
+                }
+                info.*kMemInfoFields[field].member = value;
+            }
+        }
+        p = lineEnd + 1;
+    }
     return info;
 }
 
@@ -815,7 +994,7 @@ FsInfo ProcessParser::getFilesystemStats(const std::string& path) {
 }
 
 std::string ProcessParser::getPrimaryDiskName() {
-    std::ifstream stream("/proc/mounts");
+    std::ifstream stream(m_roots.proc + "/mounts");
     std::string line;
     while (std::getline(stream, line)) {
         std::stringstream ss(line);
@@ -831,31 +1010,46 @@ std::string ProcessParser::getPrimaryDiskName() {
     return "sda"; 
 }
 
-DiskStats ProcessParser::getDiskStats() {
-    DiskStats stats;
-    std::string primaryDisk = getPrimaryDiskName();
-    primaryDisk.erase(std::remove_if(primaryDisk.begin(), primaryDisk.end(), ::isdigit), primaryDisk.end());
+std::string ProcessParser::wholeDiskName(const std::string& partition) {
+    // sysfs nests a partition under its disk: class/block/sda1 -> .../block/sda/sda1.
+    std::error_code ec;
+    std::filesystem::path blockPath = m_roots.sys + "/class/block/" + partition;
+    if (std::filesystem::exists(blockPath / "partition", ec)) {
+        std::filesystem::path resolved = std::filesystem::canonical(blockPath, ec);
+        if (!ec) {
+            return resolved.parent_path().filename().string();
+        }
+    }
 
-    std::ifstream stream("/proc/diskstats");
-    std::string line;
-    while (std::getline(stream, line)) {
-        std::stringstream ss(line);
-        std::string name;
-        ss >> name >> name >> name; 
-        if (name == primaryDisk) {
-            ss >> stats.sectorsRead;
-            ss >> name >> name; 
-            ss >> stats.sectorsWritten;
-            ss >> name >> name; 
-            ss >> stats.timeSpentIO;
-            break;
+    // No sysfs entry: strip the partition number from the usual naming schemes.
+    const std::string& name = partition;
+    size_t digits = name.find_last_not_of("0123456789");
+    if (digits == std::string::npos || digits + 1 == name.size()) {
+        return name;
+    }
+    // nvme0n1p2 and mmcblk0p1 put a 'p' between the disk and partition numbers.
+    if (name[digits] == 'p' && digits > 0 && std::isdigit(static_cast<unsigned char>(name[digits - 1]))) {
+        return name.substr(0, digits);
+    }
+    for (const char* prefix : {"sd", "hd", "vd", "xvd"}) {
+        if (name.compare(0, std::strlen(prefix), prefix) == 0) {
+            return name.substr(0, digits + 1);
         }
     }
-    return stats;
+    return name;
+}
+
+DiskStats ProcessParser::getDiskStats() {
+    DiskStatsSnapshot snapshot;
+    if (!getDiskStatsSnapshot(snapshot)) {
+        return DiskStats();
+    }
+    const DiskCounters* disk = snapshot.find(wholeDiskName(getPrimaryDiskName()));
+    return disk ? disk->toDiskStats() : DiskStats();
 }
 
 std::string ProcessParser::getPrimaryNetworkInterface() {
-    std::ifstream stream("/proc/net/route");
+    std::ifstream stream(m_roots.proc + "/net/route");
     std::string line;
     while (std::getline(stream, line)) {
         std::stringstream ss(line);
@@ -871,7 +1065,7 @@ std::string ProcessParser::getPrimaryNetworkInterface() {
 NetStats ProcessParser::getNetworkStats() {
     NetStats stats;
     std::string iface = getPrimaryNetworkInterface();
-    std::ifstream stream("/proc/net/dev");
+    std::ifstream stream(m_roots.proc + "/net/dev");
     std::string line;
     while (std::getline(stream, line)) {
         if (line.find(iface) != std::string::npos) {
@@ -889,9 +1083,21 @@ NetStats ProcessParser::getNetworkStats() {
 
 
 bool ProcessParser::isRocmSmiAvailable() {
-    std::string result = executeCommand("which rocm-smi 2>/dev/null");
-    trim(result);
-    return !result.empty();
+    // Probed once per parser: looking through PATH is cheap, but the answer
+    // does not change while we run and this used to fork `which` every tick.
+    if (m_rocmSmiAvailable < 0) {
+        m_rocmSmiAvailable = 0;
+        const char* path = std::getenv("PATH");
+        std::stringstream dirs(path ? path : "");
+        std::string dir;
+        while (std::getline(dirs, dir, ':')) {
+            if (!dir.empty() && access((dir + "/rocm-smi").c_str(), X_OK) == 0) {
+                m_rocmSmiAvailable = 1;
+                break;
+            }
+        }
+    }
+    return m_rocmSmiAvailable == 1;
 }
 
 
@@ -946,7 +1152,7 @@ AmdGpuInfo ProcessParser::getAmdGpuStats() {
         }
     } else {
         try {
-            std::string drmPath = "/sys/class/drm/";
+            std::string drmPath = m_roots.sys + "/class/drm/";
             for (const auto& entry : std::filesystem::directory_iterator(drmPath)) {
                 std::string filename = entry.path().filename().string();
                 if (filename.rfind("card", 0) == 0 && std::all_of(filename.begin() + 4, filename.end(), ::isdigit)) {
@@ -1008,7 +1214,7 @@ std::string ProcessParser::formatAmdGpuInfoToJson(const AmdGpuInfo& info) {
 
 std::vector<std::string> ProcessParser::getMountedPartitions() {
     std::set<std::string> partitions_set;
-    std::ifstream mountsFile("/proc/mounts");
+    std::ifstream mountsFile(m_roots.proc + "/mounts");
     
     if (!mountsFile.is_open()) {
         return {"/"};
@@ -1036,7 +1242,7 @@ std::vector<std::string> ProcessParser::getMountedPartitions() {
 
 
 std::string ProcessParser::getDeviceForMountPoint(std::string mountPath) {
-    std::ifstream file("/proc/mounts");
+    std::ifstream file(m_roots.proc + "/mounts");
     std::string line;
     while (std::getline(file, line)) {
         std::istringstream iss(line);
@@ -1055,30 +1261,144 @@ std::string ProcessParser::getDeviceForMountPoint(std::string mountPath) {
 
 // This is your new *overloaded* function to get stats for one specific device
 DiskStats ProcessParser::getDiskStats(std::string deviceName) {
-    std::ifstream file("/proc/diskstats");
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        int major, minor;
-        std::string device;
-        if (!(iss >> major >> minor >> device)) continue;
-
-        if (device == deviceName) {
-            DiskStats stats = {};
-            std::string token;
-            // Parse the /proc/diskstats line.
-            // Column 6 (index 5) is sectorsRead
-            // Column 10 (index 9) is sectorsWritten
-            // Column 13 (index 12) is timeSpentIO
-            for (int i = 0; i < 3; ++i) iss >> token; // Skip (reads merged, etc.)
-            iss >> stats.sectorsRead; // Col 6
-            for (int i = 0; i < 3; ++i) iss >> token; // Skip (time_read, etc.)
-            iss >> stats.sectorsWritten; // Col 10
-            iss >> token; // Skip (writes_merged)
-            iss >> token; // Skip (time_write)
-            iss >> stats.timeSpentIO; // Col 13
-            return stats;
+    DiskStatsSnapshot snapshot;
+    if (!getDiskStatsSnapshot(snapshot)) {
+        return {};
+    }
+    const DiskCounters* disk = snapshot.find(deviceName);
+    return disk ? disk->toDiskStats() : DiskStats();
+}
+
+int DiskStatsSnapshot::indexOf(const std::string& name, int hint) const {
+    if (hint >= 0 && hint < static_cast<int>(devices.size()) && name == devices[hint].name) {
+        return hint;
+    }
+    for (size_t i = 0; i < devices.size(); ++i) {
+        if (name == devices[i].name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+static const char* scanDiskField(const char* p, const char* end, uint64_t& value) {
+    while (p < end && *p == ' ') ++p;
+    uint64_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    value = v;
+    return p;
+}
+
+// Reads all of path into buffer, which keeps the largest size seen. Returns
+// the byte count, or -1 when the file cannot be opened.
+static ssize_t readWholeFile(const std::string& path, std::vector<char>& buffer) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    size_t used = 0;
+    while (true) {
+        if (buffer.size() - used < 4096) {
+            buffer.resize(std::max<size_t>(16384, buffer.size() * 2));
+        }
+        ssize_t len = read(fd, buffer.data() + used, buffer.size() - used);
+        if (len <= 0) break;
+        used += static_cast<size_t>(len);
+    }
+    close(fd);
+    return static_cast<ssize_t>(used);
+}
+
+bool ProcessParser::getDiskStatsSnapshot(DiskStatsSnapshot& out) {
+    out.devices.clear();
+    // One line per block device, loop and ram devices included, so the file
+    // can run to tens of KB.
+    ssize_t used = readWholeFile(m_diskstatsPath, m_diskstatsBuffer);
+    if (used < 0) {
+        return false;
+    }
+
+    const char* p = m_diskstatsBuffer.data();
+    const char* end = p + used;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = nl ? nl : end;
+
+        out.devices.emplace_back();
+        DiskCounters& disk = out.devices.back();
+        uint64_t value = 0;
+        p = scanDiskField(p, lineEnd, value);
+        disk.major = static_cast<unsigned>(value);
+        p = scanDiskField(p, lineEnd, value);
+        disk.minor = static_cast<unsigned>(value);
+        while (p < lineEnd && *p == ' ') ++p;
+        size_t nameLen = 0;
+        while (p < lineEnd && *p != ' ') {
+            if (nameLen + 1 < sizeof(disk.name)) disk.name[nameLen++] = *p;
+            ++p;
+        }
+        disk.name[nameLen] = '\0';
+
+        uint64_t* fields[] = {
+            &disk.readsCompleted, &disk.readsMerged, &disk.sectorsRead, &disk.msReading,
+            &disk.writesCompleted, &disk.writesMerged, &disk.sectorsWritten, &disk.msWriting,
+            &disk.iosInProgress, &disk.msDoingIo, &disk.weightedMsDoingIo,
+            &disk.discardsCompleted, &disk.discardsMerged, &disk.sectorsDiscarded, &disk.msDiscarding,
+            &disk.flushesCompleted, &disk.msFlushing,
+        };
+        for (uint64_t* field : fields) {
+            if (p >= lineEnd) break;
+            p = scanDiskField(p, lineEnd, *field);
+        }
+        if (nameLen == 0) {
+            out.devices.pop_back();
         }
+        p = lineEnd + 1;
     }
-    return {}; // Return empty stats if not found
-}
\ No newline at end of file
+    return true;
+}
+bool ProcessParser::getInterfaceCounters(std::vector<InterfaceCounters>& out) {
+    out.clear();
+    // Grows with every veth and bridge on a container host.
+    ssize_t used = readWholeFile(m_netDevPath, m_netDevBuffer);
+    if (used < 0) {
+        return false;
+    }
+
+    const char* p = m_netDevBuffer.data();
+    const char* end = p + used;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = nl ? nl : end;
+        // The two header lines have no colon before their first '|'.
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', lineEnd - p));
+        if (colon) {
+            while (p < colon && *p == ' ') ++p;
+            out.emplace_back();
+            InterfaceCounters& iface = out.back();
+            size_t nameLen = std::min(static_cast<size_t>(colon - p), sizeof(iface.name) - 1);
+            std::memcpy(iface.name, p, nameLen);
+            iface.name[nameLen] = '\0';
+
+            // bytes packets errs drop fifo frame compressed multicast, for
+            // receive and then transmit.
+            uint64_t fields[16] = {};
+            p = colon + 1;
+            for (uint64_t& field : fields) {
+                if (p >= lineEnd) break;
+                p = scanDiskField(p, lineEnd, field);
+            }
+            iface.rxBytes = fields[0];
+            iface.rxPackets = fields[1];
+            iface.rxErrors = fields[2];
+            iface.rxDropped = fields[3];
+            iface.txBytes = fields[8];
+            iface.txPackets = fields[9];
+            iface.txErrors = fields[10];
+            iface.txDropped = fields[11];
+        }
+        p = lineEnd + 1;
+    }
+    return true;
+}